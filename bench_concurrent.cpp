@@ -0,0 +1,84 @@
+// bench_concurrent.cpp
+// Author: Yusen Liu
+// Scalability benchmark: shared hand under a global mutex (CardList) versus the
+// lock-free ConcurrentCardSet, from 1 to N threads.
+// Usage: ./bench_concurrent [max_threads] [ops_per_thread]
+
+#include <iostream>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "card.h"
+#include "card_list.h"
+#include "concurrent_card_set.h"
+
+using namespace std;
+
+// Mixed dealer workload: 50% contains, 25% insert, 25% erase on random cards
+template <class Op>
+double runThreads(int threads, int opsPerThread, Op op) {
+    vector<Card> deck;
+    for (int code = 0; code < 52; code++) {
+        deck.push_back(Card::fromCode(code));
+    }
+
+    auto start = chrono::steady_clock::now();
+    vector<thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            mt19937 rng(t + 1);
+            for (int i = 0; i < opsPerThread; i++) {
+                unsigned r = rng();
+                op(deck[r % 52], (r >> 8) & 3);
+            }
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return threads * double(opsPerThread) / seconds / 1e6;
+}
+
+int main(int argv, char** argc) {
+    int maxThreads = argv > 1 ? stoi(argc[1]) : int(thread::hardware_concurrency());
+    int opsPerThread = argv > 2 ? stoi(argc[2]) : 1000000;
+    if (maxThreads < 1) maxThreads = 1;
+
+    cout << "threads  mutex+CardList(Mops/s)  ConcurrentCardSet(Mops/s)" << endl;
+    // Powers of two below maxThreads, then maxThreads itself once
+    for (int threads = 1; threads <= maxThreads;
+         threads = threads == maxThreads ? maxThreads + 1 : std::min(threads * 2, maxThreads)) {
+        CardList locked;
+        mutex lock;
+        double lockedRate = runThreads(threads, opsPerThread, [&](const Card& c, unsigned kind) {
+            lock_guard<mutex> guard(lock);
+            if (kind == 0) {
+                if (!locked.contains(c)) locked.insert(c);
+            } else if (kind == 1) {
+                locked.erase(c);
+            } else {
+                volatile bool found = locked.contains(c);
+                (void)found;
+            }
+        });
+
+        ConcurrentCardSet shared;
+        double lockFreeRate = runThreads(threads, opsPerThread, [&](const Card& c, unsigned kind) {
+            if (kind == 0) {
+                shared.insert(c);
+            } else if (kind == 1) {
+                shared.erase(c);
+            } else {
+                volatile bool found = shared.contains(c);
+                (void)found;
+            }
+        });
+
+        cout << threads << "        " << lockedRate << "                  " << lockFreeRate << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,86 @@
+// bench_intersect.cpp
+// Author: Yusen Liu
+// Intersection plus both leftover hands on packed sorted key arrays:
+// std::set_intersection/set_difference versus the scalar merge and the SSE4.2
+// block-compare kernel, for hands of similar size and for a small hand against
+// a large one (where galloping takes over).
+// Usage: ./bench_intersect [thousand cards per hand]
+
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+#include "intersect.h"
+
+using namespace std;
+
+// Time fn over enough repetitions to be measurable, in microseconds per call
+template <class Fn>
+static double timeCall(Fn fn) {
+    int reps = 0;
+    auto start = chrono::steady_clock::now();
+    double seconds = 0;
+    do {
+        fn();
+        reps++;
+        seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    } while (seconds < 0.2);
+    return seconds / reps * 1e6;
+}
+
+// A shoe of about count cards with random copy counts, packed
+static vector<uint16_t> randomHand(size_t count, mt19937& rng) {
+    vector<uint8_t> codes;
+    for (int code = 0; code < 52; code++) {
+        size_t copies = min<size_t>(1023, count / 52 / 2 + rng() % (count / 52 + 1));
+        codes.insert(codes.end(), copies, uint8_t(code));
+    }
+    vector<uint16_t> keys;
+    packHand(codes.data(), codes.size(), keys);
+    return keys;
+}
+
+static void compare(const char* label, const vector<uint16_t>& a, const vector<uint16_t>& b) {
+    cout << label << ": " << a.size() << " and " << b.size() << " cards" << endl;
+    vector<uint16_t> shared(min(a.size(), b.size()));
+    vector<uint16_t> onlyA(a.size());
+    vector<uint16_t> onlyB(b.size());
+    size_t sink = 0;
+
+    double stdTime = timeCall([&]() {
+        auto s = set_intersection(a.begin(), a.end(), b.begin(), b.end(), shared.begin());
+        auto x = set_difference(a.begin(), a.end(), b.begin(), b.end(), onlyA.begin());
+        auto y = set_difference(b.begin(), b.end(), a.begin(), a.end(), onlyB.begin());
+        sink += (s - shared.begin()) + (x - onlyA.begin()) + (y - onlyB.begin());
+    });
+    cout << "  std::set_*:       " << stdTime << " us" << endl;
+
+    for (IntersectKernel kernel : {INTERSECT_SCALAR, INTERSECT_SSE42}) {
+        if (!intersectKernelSupported(kernel)) continue;
+        double t = timeCall([&]() {
+            IntersectResult r = intersectPackedWith(kernel, a.data(), a.size(), b.data(), b.size(),
+                                                    shared.data(), onlyA.data(), onlyB.data());
+            sink += r.shared + r.onlyA + r.onlyB;
+        });
+        string name = intersectKernelName(kernel);
+        cout << "  " << name << string(max<int>(1, 18 - name.size()), ' ') << t << " us  ("
+             << stdTime / t << "x)" << endl;
+    }
+    if (sink == 0) cout << "";
+}
+
+int main(int argv, char** argc) {
+    size_t thousands = argv > 1 ? stoul(argc[1]) : 50;
+    mt19937 rng(43);
+
+    vector<uint16_t> a = randomHand(thousands * 1000, rng);
+    vector<uint16_t> b = randomHand(thousands * 1000, rng);
+    compare("Similar hands", a, b);
+
+    vector<uint16_t> small = randomHand(thousands * 10, rng);
+    compare("Small against large", small, b);
+    return 0;
+}
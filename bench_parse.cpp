@@ -0,0 +1,66 @@
+// bench_parse.cpp
+// Author: Yusen Liu
+// Hand file parsing throughput: istream >> Card and the validating line reader
+// versus the bulk parser kernels.
+// Usage: ./bench_parse [megabytes]
+
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "card.h"
+#include "hand_file.h"
+#include "hand_parser.h"
+
+using namespace std;
+
+int main(int argv, char** argc) {
+    size_t megabytes = argv > 1 ? stoul(argc[1]) : 64;
+
+    // Random multi-deck hand text in the usual one-card-per-line format
+    mt19937 rng(7);
+    ostringstream text;
+    while (size_t(text.tellp()) < megabytes << 20) {
+        text << Card::fromCode(rng() % 52) << '\n';
+    }
+    string data = text.str();
+    double gigabytes = data.size() / 1e9;
+    cout << "Parsing " << data.size() << " bytes" << endl;
+
+    // Current path: one operator>> per card
+    {
+        auto start = chrono::steady_clock::now();
+        istringstream in(data);
+        vector<Card> cards;
+        Card c;
+        while (in >> c) {
+            cards.push_back(c);
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << "istream >> Card: " << cards.size() << " cards, " << gigabytes / seconds << " GB/s" << endl;
+    }
+
+    // Fallback path: validating reader with line numbers
+    {
+        auto start = chrono::steady_clock::now();
+        istringstream in(data);
+        vector<Card> cards;
+        vector<CardReadError> errors;
+        readTextCards(in, "bench", REJECT_BAD_CARDS, cards, errors);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << "readTextCards: " << cards.size() << " cards, " << gigabytes / seconds << " GB/s" << endl;
+    }
+
+    vector<uint8_t> codes(maxCardsInText(data.size()));
+    for (HandParserKernel kernel : {PARSER_SCALAR, PARSER_SSE2, PARSER_AVX2}) {
+        if (!handParserKernelSupported(kernel)) continue;
+        auto start = chrono::steady_clock::now();
+        HandParseResult result = parseHandTextWith(kernel, data.data(), data.size(), codes.data(), codes.size());
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << "parseHandText (" << handParserKernelName(kernel) << "): " << result.cards << " cards, "
+             << gigabytes / seconds << " GB/s" << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,73 @@
+// bench_setops.cpp
+// Author: Yusen Liu
+// Intersection/union/difference of two multi-deck shoes: std::set_* algorithms
+// walking every copy versus CardList's split/join set operations, sequential and
+// on several threads.
+// Usage: ./bench_setops [million cards per hand] [threads]
+
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "card.h"
+#include "card_list.h"
+
+using namespace std;
+
+// Time fn over enough repetitions to be measurable, in microseconds per call
+template <class Fn>
+static double timeCall(Fn fn) {
+    int reps = 0;
+    auto start = chrono::steady_clock::now();
+    double seconds = 0;
+    do {
+        fn();
+        reps++;
+        seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    } while (seconds < 0.2);
+    return seconds / reps * 1e6;
+}
+
+int main(int argv, char** argc) {
+    size_t millions = argv > 1 ? stoul(argc[1]) : 10;
+    int threads = argv > 2 ? stoi(argc[2]) : max(1u, thread::hardware_concurrency());
+
+    // Two shoes with random copy counts per card, bulk-built from sorted input
+    mt19937 rng(39);
+    CardList hands[2];
+    for (CardList& hand : hands) {
+        vector<Card> cards;
+        cards.reserve(millions * 1000000);
+        for (int code = 0; code < 52; code++) {
+            size_t copies = millions * 1000000 / 52 / 2 + rng() % (millions * 1000000 / 52);
+            cards.insert(cards.end(), copies, Card::fromCode(code));
+        }
+        hand.assignSorted(cards.data(), cards.size());
+    }
+    const CardList& a = hands[0];
+    const CardList& b = hands[1];
+    cout << "Hands of " << a.size() << " and " << b.size() << " cards, " << threads << " threads" << endl;
+
+    size_t sink = 0;
+    double stdTime = timeCall([&]() {
+        vector<Card> shared;
+        set_intersection(a.begin(), a.end(), b.begin(), b.end(), back_inserter(shared));
+        sink += shared.size();
+    });
+    cout << "std::set_intersection:     " << stdTime << " us" << endl;
+
+    for (int t : {1, threads}) {
+        double meet = timeCall([&]() { sink += CardList::setIntersection(a, b, t).size(); });
+        double join = timeCall([&]() { sink += CardList::setUnion(a, b, t).size(); });
+        double diff = timeCall([&]() { sink += CardList::setDifference(a, b, t).size(); });
+        cout << "CardList set ops, " << t << " thread(s): intersection " << meet << " us, union " << join
+             << " us, difference " << diff << " us" << endl;
+    }
+
+    cout << "(checksum " << sink << ")" << endl;
+    return 0;
+}
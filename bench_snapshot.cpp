@@ -0,0 +1,82 @@
+// bench_snapshot.cpp
+// Author: Yusen Liu
+// One writer mutating a SnapshotCardList while 0..N reader threads scan snapshots.
+// Reports reader scans per second and the writer's mean/max update latency.
+// Usage: ./bench_snapshot [max_readers] [milliseconds_per_run]
+
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "card.h"
+#include "snapshot_card_list.h"
+
+using namespace std;
+
+int main(int argv, char** argc) {
+    int maxReaders = argv > 1 ? stoi(argc[1]) : int(thread::hardware_concurrency());
+    int millis = argv > 2 ? stoi(argc[2]) : 1000;
+
+    vector<Card> deck;
+    for (int code = 0; code < 52; code++) {
+        deck.push_back(Card::fromCode(code));
+    }
+
+    cout << "readers  scans/s(total)  writer_mean_ns  writer_max_ns" << endl;
+    for (int readers = 0; readers <= maxReaders; readers = readers == 0 ? 1 : readers * 2) {
+        SnapshotCardList hand;
+        for (int code = 0; code < 52; code += 2) {
+            hand.insert(deck[code]);
+        }
+
+        atomic<bool> stop(false);
+        atomic<long> scans(0);
+        vector<thread> threads;
+        for (int r = 0; r < readers; r++) {
+            threads.emplace_back([&]() {
+                int id = hand.registerReader();
+                long local = 0;
+                while (!stop.load(memory_order_relaxed)) {
+                    SnapshotCardList::Snapshot snap = hand.read(id);
+                    size_t count = 0;
+                    for (auto it = snap.begin(); it != snap.end(); ++it) {
+                        count++;
+                    }
+                    if (count == snap.getSize()) local++;
+                }
+                scans += local;
+                hand.unregisterReader(id);
+            });
+        }
+
+        // Writer: toggle random cards and time each update
+        mt19937 rng(42);
+        long updates = 0;
+        double totalNs = 0, maxNs = 0;
+        auto deadline = chrono::steady_clock::now() + chrono::milliseconds(millis);
+        while (chrono::steady_clock::now() < deadline) {
+            const Card& c = deck[rng() % 52];
+            auto start = chrono::steady_clock::now();
+            if (hand.contains(c)) {
+                hand.erase(c);
+            } else {
+                hand.insert(c);
+            }
+            double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+            totalNs += ns;
+            if (ns > maxNs) maxNs = ns;
+            updates++;
+        }
+        stop = true;
+        for (auto& t : threads) {
+            t.join();
+        }
+
+        cout << readers << "        " << scans.load() * 1000.0 / millis << "        "
+             << totalNs / updates << "        " << maxNs << endl;
+    }
+    return 0;
+}
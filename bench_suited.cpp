@@ -0,0 +1,65 @@
+// bench_suited.cpp
+// Author: Yusen Liu
+// The game workload (build both hands, play, print) on CardList versus the
+// suit-partitioned SuitedCardList.
+// Usage: ./bench_suited [games] [decks]
+
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "card.h"
+#include "card_list.h"
+#include "suited_card_list.h"
+#include "game.h"
+#include "game_outcome.h"
+
+using namespace std;
+
+// Play every game on a fresh pair of Hand, returning games per second
+template <class Hand, class Play>
+static double run(const vector<vector<Card>>& hands, Play play, size_t& checksum) {
+    auto start = chrono::steady_clock::now();
+    for (size_t g = 0; g + 1 < hands.size(); g += 2) {
+        Hand alice, bob;
+        for (const Card& c : hands[g]) alice.insert(c);
+        for (const Card& c : hands[g + 1]) bob.insert(c);
+        ostringstream out;
+        play(alice, bob, out);
+        checksum += hash<string>()(out.str());
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return hands.size() / 2 / seconds;
+}
+
+int main(int argv, char** argc) {
+    size_t games = argv > 1 ? stoul(argc[1]) : 20000;
+    int decks = argv > 2 ? stoi(argc[2]) : 1;
+
+    // Random hands from a shoe of the given size, anywhere from empty to full
+    mt19937 rng(42);
+    vector<vector<Card>> hands(games * 2);
+    for (auto& hand : hands) {
+        int percent = rng() % 101;
+        for (int d = 0; d < decks; d++) {
+            for (const Card& c : FULL_DECK) {
+                if (int(rng() % 100) < percent) hand.push_back(c);
+            }
+        }
+        shuffle(hand.begin(), hand.end(), rng);
+    }
+    cout << games << " games, " << decks << " deck(s) per hand" << endl;
+
+    size_t a = 0, b = 0, c = 0;
+    double tree = run<CardList>(hands, [](CardList& x, CardList& y, ostream& out) { playGame(x, y, out); }, a);
+    double suited = run<SuitedCardList>(hands, [](SuitedCardList& x, SuitedCardList& y, ostream& out) { playGame(x, y, out); }, b);
+    double fast = run<CardList>(hands, [](CardList& x, CardList& y, ostream& out) { playFast(x, y, out); }, c);
+    cout << "CardList playGame:       " << tree << " games/s" << endl;
+    cout << "SuitedCardList playGame: " << suited << " games/s" << endl;
+    cout << "CardList playFast:       " << fast << " games/s" << endl;
+    cout << (a == b && b == c ? "outputs agree" : "OUTPUTS DIFFER") << endl;
+    return a == b && b == c ? 0 : 1;
+}
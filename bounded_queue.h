@@ -0,0 +1,136 @@
+// bounded_queue.h
+// Author: Yusen Liu
+// Fixed-capacity lock-free multi-producer/multi-consumer queue (Vyukov's ring of
+// sequence-numbered cells). push() waits while the queue is full, which is how
+// the streaming pipeline applies backpressure to faster stages. Waits spin
+// briefly, then sleep on a counter (C++20 atomic wait) so an idle stage costs no
+// CPU.
+
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
+
+template <class T>
+class BoundedQueue {
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::vector<Cell> cells;
+    size_t mask;
+    alignas(64) std::atomic<size_t> head;   // next slot to pop
+    alignas(64) std::atomic<size_t> tail;   // next slot to push
+    alignas(64) std::atomic<bool> closed;
+    // Bumped after every push (and by close) and every pop, for waiters to sleep on
+    alignas(64) std::atomic<uint32_t> pushes;
+    alignas(64) std::atomic<uint32_t> pops;
+
+    static constexpr int SPINS = 64;
+
+public:
+    // capacity is rounded up to a power of two
+    explicit BoundedQueue(size_t capacity) : head(0), tail(0), closed(false), pushes(0), pops(0) {
+        size_t size = 2;
+        while (size < capacity) size *= 2;
+        cells = std::vector<Cell>(size);
+        for (size_t i = 0; i < size; i++) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        mask = size - 1;
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    // Returns false if the queue is full
+    bool tryPush(T& value) {
+        size_t pos = tail.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells[pos & mask];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            if (seq == pos) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = std::move(value);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    pushes.fetch_add(1, std::memory_order_release);
+                    pushes.notify_all();
+                    return true;
+                }
+            } else if (seq < pos) {
+                return false;
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Returns false if the queue is empty
+    bool tryPop(T& value) {
+        size_t pos = head.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells[pos & mask];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            if (seq == pos + 1) {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    value = std::move(cell.value);
+                    cell.sequence.store(pos + mask + 1, std::memory_order_release);
+                    pops.fetch_add(1, std::memory_order_release);
+                    pops.notify_all();
+                    return true;
+                }
+            } else if (seq < pos + 1) {
+                return false;
+            } else {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Wait for room. The counter is read before each try, so a pop between a
+    // failed try and the wait wakes it.
+    void push(T value) {
+        for (int spin = 0;; spin++) {
+            uint32_t seen = pops.load(std::memory_order_acquire);
+            if (tryPush(value)) return;
+            if (spin < SPINS) {
+                std::this_thread::yield();
+            } else {
+                pops.wait(seen, std::memory_order_acquire);
+            }
+        }
+    }
+
+    // Wait for an item. Returns false once the queue is closed and drained.
+    bool pop(T& value) {
+        for (int spin = 0;; spin++) {
+            uint32_t seen = pushes.load(std::memory_order_acquire);
+            if (tryPop(value)) return true;
+            if (closed.load(std::memory_order_acquire)) {
+                // Items pushed before close() are still delivered
+                return tryPop(value);
+            }
+            if (spin < SPINS) {
+                std::this_thread::yield();
+            } else {
+                pushes.wait(seen, std::memory_order_acquire);
+            }
+        }
+    }
+
+    // No more pushes will follow
+    void close() {
+        closed.store(true, std::memory_order_release);
+        pushes.fetch_add(1, std::memory_order_release);
+        pushes.notify_all();
+    }
+};
+
+#endif
@@ -4,91 +4,55 @@
 
 #include "card.h"
 
-// Helper function to convert value string to numeric rank for comparison
-int Card::getValueRank() const {
-    if (value == "a") return 1;
-    else if (value == "j") return 11;
-    else if (value == "q") return 12;
-    else if (value == "k") return 13;
-    else {
-        // Handle numeric values 2-10
-        return stoi(value);
+// Ordering invariants the card codes, hand files and bitmask containers rely on
+static_assert(Card::fromCode(0) == "ca"_card && Card::fromCode(51) == "hk"_card);
+static_assert("c10"_card < "cj"_card && "ck"_card < "da"_card && "dk"_card < "sa"_card && "sk"_card < "ha"_card);
+static_assert("h10"_card == Card('h', "10") && "h 10"_card == "h10"_card);
+static_assert([]() {
+    for (int code = 0; code < 52; code++) {
+        if (FULL_DECK[code].toCode() != code) return false;
+        if (code > 0 && !(FULL_DECK[code - 1] < FULL_DECK[code])) return false;
     }
-}
-
-// Default constructor
-Card::Card() : suit(' '), value("") {}
-
-// Constructor with suit and value
-Card::Card(char s, const string& v) : suit(s), value(v) {}
-
-// Get suit rank for comparison (c=0, d=1, s=2, h=3)
-static int getSuitRank(char suit) {
-    switch(suit) {
-        case 'c': return 0;
-        case 'd': return 1;
-        case 's': return 2;
-        case 'h': return 3;
-        default: return -1;
-    }
-}
-
-// Less than operator
-bool Card::operator<(const Card& other) const {
-    int thisSuitRank = getSuitRank(suit);
-    int otherSuitRank = getSuitRank(other.suit);
-    
-    if (thisSuitRank != otherSuitRank) {
-        return thisSuitRank < otherSuitRank;
-    }
-    
-    // Same suit, compare by value
-    return getValueRank() < other.getValueRank();
-}
-
-// Greater than operator
-bool Card::operator>(const Card& other) const {
-    return other < *this;
-}
-
-// Equal operator
-bool Card::operator==(const Card& other) const {
-    return suit == other.suit && value == other.value;
-}
-
-// Less than or equal operator
-bool Card::operator<=(const Card& other) const {
-    return *this < other || *this == other;
-}
-
-// Greater than or equal operator
-bool Card::operator>=(const Card& other) const {
-    return *this > other || *this == other;
-}
-
-// Not equal operator
-bool Card::operator!=(const Card& other) const {
-    return !(*this == other);
-}
+    return true;
+}(), "FULL_DECK must be in card order and match the card codes");
+static_assert(Card('x', "3").toCode() == -1 && Card('h', "1").toCode() == -1 && Card().toCode() == -1);
+static_assert(sizeof(Card) == 2);
+static_assert([]() {
+    Card card;
+    return Card::parse("x", "3", card) == CARD_BAD_SUIT && Card::parse("h", "1o", card) == CARD_BAD_VALUE
+        && Card::parse("h", "", card) == CARD_MISSING_VALUE && Card::parse("h", "10", card) == CARD_OK
+        && card == "h10"_card;
+}());
 
 // Output stream operator
 ostream& operator<<(ostream& os, const Card& card) {
-    os << card.suit << " " << card.value;
+    os << card.suit << " " << Card::rankName(card.rank);
     return os;
 }
 
 // Input stream operator
 istream& operator>>(istream& is, Card& card) {
-    is >> card.suit >> card.value;
+    char suit;
+    string value;
+    if (!(is >> suit)) return is;
+    is >> value;    // skips any whitespace, so "h10" and "h 10" both read
+    if (Card::parse(string_view(&suit, 1), value, card) != CARD_OK) {
+        is.setstate(ios::failbit);
+    }
     return is;
 }
 
-// Get suit
-char Card::getSuit() const {
-    return suit;
+const char* cardParseErrorMessage(CardParseError error) {
+    switch (error) {
+        case CARD_OK: return "ok";
+        case CARD_BAD_SUIT: return "suit must be c, d, s or h";
+        case CARD_BAD_VALUE: return "value must be a, 2-10, j, q or k";
+        case CARD_MISSING_VALUE: return "suit has no value after it";
+    }
+    return "unknown error";
 }
 
 // Get value
 string Card::getValue() const {
-    return value;
+    return string(rankName(rank));
 }
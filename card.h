@@ -1,43 +1,131 @@
 // card.h
 // Author: Yusen Liu
 // All class declarations related to defining a single card go here
+// A card is two bytes (suit letter and numeric rank) and everything but stream
+// I/O is constexpr, so decks and card literals like "h10"_card are built at
+// compile time and comparisons are plain integer compares.
 
 #ifndef CARD_H
 #define CARD_H
 
+#include <array>
+#include <cstdint>
 #include <iostream>
 #include <string>
+#include <string_view>
 
 using namespace std;
 
+// Why a suit/value token pair is not a card
+enum CardParseError { CARD_OK, CARD_BAD_SUIT, CARD_BAD_VALUE, CARD_MISSING_VALUE };
+
 class Card {
 private:
     char suit;      // 'c', 'd', 's', 'h'
-    string value;   // "a", "2", ..., "10", "j", "q", "k"
-    
-    // Helper function to convert value to numeric rank for comparison
-    int getValueRank() const;
-    
+    uint8_t rank;   // 1 (a) .. 13 (k); 0 for a value that isn't a card value
+
+    constexpr Card(char s, int r) : suit(s), rank(uint8_t(r)) {}
+
+    // Ordering key: suit-major (c < d < s < h), then rank
+    constexpr int orderKey() const { return suitRank(suit) * 16 + rank; }
+
 public:
+    // Suit rank for comparison (c=0, d=1, s=2, h=3), -1 for anything else
+    static constexpr int suitRank(char s) {
+        switch (s) {
+            case 'c': return 0;
+            case 'd': return 1;
+            case 's': return 2;
+            case 'h': return 3;
+            default: return -1;
+        }
+    }
+
+    // Rank of a value token ("a", "2", ..., "10", "j", "q", "k"), 0 if it isn't one
+    static constexpr int parseRank(string_view v) {
+        if (v.size() == 1) {
+            switch (v[0]) {
+                case 'a': return 1;
+                case 'j': return 11;
+                case 'q': return 12;
+                case 'k': return 13;
+                default: return v[0] >= '2' && v[0] <= '9' ? v[0] - '0' : 0;
+            }
+        }
+        return v == "10" ? 10 : 0;
+    }
+
+    // Value token of a rank, "" for rank 0
+    static constexpr string_view rankName(int r) {
+        constexpr string_view names[] = {"", "a", "2", "3", "4", "5", "6", "7", "8", "9", "10", "j", "q", "k"};
+        return r >= 0 && r <= 13 ? names[r] : "";
+    }
+
+    // Validate a suit token and a value token and build the card from them. Never
+    // throws; card is left alone on error. This is the only place text becomes a
+    // card, so a stored card never needs parsing again.
+    static constexpr CardParseError parse(string_view s, string_view v, Card& card) {
+        if (s.size() != 1 || suitRank(s[0]) < 0) return CARD_BAD_SUIT;
+        if (v.empty()) return CARD_MISSING_VALUE;
+        int r = parseRank(v);
+        if (r == 0) return CARD_BAD_VALUE;
+        card = Card(s[0], r);
+        return CARD_OK;
+    }
+
     // Constructors
-    Card();
-    Card(char s, const string& v);
-    
+    constexpr Card() : suit(' '), rank(0) {}
+    constexpr Card(char s, string_view v) : suit(s), rank(uint8_t(parseRank(v))) {}
+
     // Comparison operators
-    bool operator<(const Card& other) const;
-    bool operator>(const Card& other) const;
-    bool operator==(const Card& other) const;
-    bool operator<=(const Card& other) const;
-    bool operator>=(const Card& other) const;
-    bool operator!=(const Card& other) const;
-    
-    // Input/Output operators
+    constexpr bool operator<(const Card& other) const { return orderKey() < other.orderKey(); }
+    constexpr bool operator>(const Card& other) const { return other < *this; }
+    constexpr bool operator==(const Card& other) const { return suit == other.suit && rank == other.rank; }
+    constexpr bool operator<=(const Card& other) const { return *this < other || *this == other; }
+    constexpr bool operator>=(const Card& other) const { return *this > other || *this == other; }
+    constexpr bool operator!=(const Card& other) const { return !(*this == other); }
+
+    // Input/Output operators. operator>> accepts "h 10" or "h10" and sets failbit
+    // on a token pair parse() rejects, leaving card unchanged.
     friend ostream& operator<<(ostream& os, const Card& card);
     friend istream& operator>>(istream& is, Card& card);
-    
+
     // Getters
-    char getSuit() const;
+    constexpr char getSuit() const { return suit; }
+    constexpr int getRank() const { return rank; }
     string getValue() const;
+
+    // Packed card code: suit rank * 13 + value rank - 1, so codes 0..51 sort in
+    // the same order as the cards. Returns -1 for a card outside the standard deck.
+    constexpr int toCode() const {
+        int s = suitRank(suit);
+        return s < 0 || rank == 0 ? -1 : s * 13 + rank - 1;
+    }
+    static constexpr Card fromCode(int code) {
+        constexpr char suits[] = {'c', 'd', 's', 'h'};
+        return Card(suits[code / 13], code % 13 + 1);
+    }
 };
 
+// Readable description of a parse error
+const char* cardParseErrorMessage(CardParseError error);
+
+// The standard deck in card order, built at compile time
+inline constexpr array<Card, 52> FULL_DECK = []() {
+    array<Card, 52> deck;
+    for (int code = 0; code < 52; code++) {
+        deck[code] = Card::fromCode(code);
+    }
+    return deck;
+}();
+
+// Card literal: "h10"_card, "ca"_card or "s k"_card. A malformed literal does not compile.
+consteval Card operator""_card(const char* text, size_t length) {
+    string_view token(text, length);
+    if (token.size() < 2 || Card::suitRank(token[0]) < 0) throw "card literal needs a suit c, d, s or h";
+    string_view value = token.substr(token[1] == ' ' ? 2 : 1);
+    if (Card::parseRank(value) == 0) throw "card literal needs a value a, 2-10, j, q or k";
+    return Card(token[0], value);
+}
+
 #endif
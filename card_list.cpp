@@ -3,26 +3,40 @@
 // Implementation of the classes defined in card_list.h
 
 #include "card_list.h"
+#include "trace.h"
+#include <algorithm>
+#include <future>
+#include <ranges>
+#include <vector>
+
+// Keep the iterators usable with the standard algorithms and std::ranges
+static_assert(std::bidirectional_iterator<CardList::Iterator>);
+static_assert(std::bidirectional_iterator<CardList::ReverseIterator>);
+static_assert(std::ranges::bidirectional_range<CardList>);
+static_assert(std::ranges::sized_range<CardList>);
+static_assert(std::ranges::common_range<CardList>);
 
 // ====== Helper Functions ======
 
 // Insert a card into the BST
 CardList::Node* CardList::insertHelper(Node* node, const Card& card, Node* parent) {
     if (node == nullptr) {
-        Node* newNode = new Node(card);
+        Node* leaf = newNode(card);
         //since the node is nullptr, meaning it is a leaf node, so we need to set the parent pointer of the new node to the parent node
-        newNode->parent = parent;
-        return newNode;
+        leaf->parent = parent;
+        return leaf;
     }
     
     if (card < node->data) {
         node->left = insertHelper(node->left, card, node);
     } else if (card > node->data) {
         node->right = insertHelper(node->right, card, node);
+    } else {
+        // Another copy of a card we already hold (multi-deck): just count it
+        node->count++;
     }
-    // If equal, we don't insert duplicates because the rules said only one copy of each card. 
     
-    return node;
+    return rebalance(node);
 }
 
 // Find a card in the BST
@@ -39,7 +53,7 @@ CardList::Node* CardList::findHelper(Node* node, const Card& card) const {
 }
 
 // Find the node with minimum value in subtree rooted at node
-CardList::Node* CardList::findMin(Node* node) const {
+CardList::Node* CardList::findMin(Node* node) {
     if (node == nullptr) return nullptr;
     while (node->left != nullptr) {
         node = node->left;
@@ -48,7 +62,7 @@ CardList::Node* CardList::findMin(Node* node) const {
 }
 
 // Find the node with maximum value in subtree rooted at node
-CardList::Node* CardList::findMax(Node* node) const {
+CardList::Node* CardList::findMax(Node* node) {
     if (node == nullptr) return nullptr;
     while (node->right != nullptr) {
         node = node->right;
@@ -90,7 +104,7 @@ CardList::Node* CardList::findPredecessor(Node* node) const {
     return current->parent;
 }
 
-// Erase a card from the BST
+// Erase a card's node (all of its copies) from the BST
 CardList::Node* CardList::eraseHelper(Node* node, const Card& card) {
     if (node == nullptr) return nullptr;
     
@@ -105,7 +119,7 @@ CardList::Node* CardList::eraseHelper(Node* node, const Card& card) {
         
         // Case 1: Node has no children
         if (node->left == nullptr && node->right == nullptr) {
-            delete node;
+            recycleNode(node);
             return nullptr;
         }
         
@@ -113,7 +127,7 @@ CardList::Node* CardList::eraseHelper(Node* node, const Card& card) {
         if (node->left == nullptr) {
             Node* temp = node->right;
             temp->parent = node->parent;
-            delete node;
+            recycleNode(node);
             return temp;
         }
         
@@ -121,7 +135,7 @@ CardList::Node* CardList::eraseHelper(Node* node, const Card& card) {
         if (node->right == nullptr) {
             Node* temp = node->left;
             temp->parent = node->parent;
-            delete node;
+            recycleNode(node);
             return temp;
         }
         
@@ -129,13 +143,43 @@ CardList::Node* CardList::eraseHelper(Node* node, const Card& card) {
         // Find the inorder successor (smallest in right subtree)
         Node* successor = findMin(node->right);
         node->data = successor->data;
+        node->count = successor->count;
         node->right = eraseHelper(node->right, successor->data);
         if (node->right != nullptr) node->right->parent = node;
     }
     
+    return rebalance(node);
+}
+
+// Build a balanced subtree from the strictly ascending range cards[lo, hi)
+CardList::Node* CardList::buildBalanced(const Card* cards, const size_t* counts, size_t lo, size_t hi, Node* parent) {
+    if (lo >= hi) return nullptr;
+    
+    size_t mid = lo + (hi - lo) / 2;
+    Node* node = newNode(cards[mid]);
+    node->count = counts[mid];
+    node->parent = parent;
+    node->left = buildBalanced(cards, counts, lo, mid, node);
+    node->right = buildBalanced(cards, counts, mid + 1, hi, node);
+    update(node);
     return node;
 }
 
+// Deep copy of a subtree, same shape
+CardList::Node* CardList::copyTree(const Node* node, Node* parent) {
+    if (node == nullptr) return nullptr;
+    
+    Node* copy = new Node(node->data);
+    addOwned(1);
+    copy->count = node->count;
+    copy->total = node->total;
+    copy->height = node->height;
+    copy->parent = parent;
+    copy->left = copyTree(node->left, copy);
+    copy->right = copyTree(node->right, copy);
+    return copy;
+}
+
 // Delete entire tree
 void CardList::deleteTree(Node* node) {
     if (node == nullptr) return;
@@ -144,11 +188,351 @@ void CardList::deleteTree(Node* node) {
     delete node;
 }
 
+// Every node of a subtree, in order
+void CardList::flatten(Node* node, std::vector<Node*>& out) {
+    if (node == nullptr) return;
+    flatten(node->left, out);
+    out.push_back(node);
+    flatten(node->right, out);
+}
+
+// Balanced subtree from existing nodes[lo, hi), already in order
+CardList::Node* CardList::linkBalanced(Node* const* nodes, size_t lo, size_t hi, Node* parent) {
+    if (lo >= hi) return nullptr;
+    
+    size_t mid = lo + (hi - lo) / 2;
+    Node* node = nodes[mid];
+    node->parent = parent;
+    node->left = linkBalanced(nodes, lo, mid, node);
+    node->right = linkBalanced(nodes, mid + 1, hi, node);
+    update(node);
+    return node;
+}
+
+void CardList::relink(const std::vector<Node*>& kept, size_t removed) {
+    root = linkBalanced(kept.data(), 0, kept.size(), nullptr);
+    cardCount -= removed;
+}
+
+void CardList::countOwned() {
+    if (ownedNodes != UNCOUNTED) return;
+    ownedNodes = countNodes(root) + spareCount;
+    peakNodes = std::max(peakNodes, ownedNodes);
+}
+
+void CardList::addOwned(size_t nodes) {
+    ownedNodes += nodes;
+    peakNodes = std::max(peakNodes, ownedNodes);
+}
+
+// A fresh leaf, from the spare list when it has one. The tree must be whole
+// when the list is UNCOUNTED (assignSorted counts before recycling it).
+CardList::Node* CardList::newNode(const Card& card) {
+    if (spare == nullptr) {
+        countOwned();
+        addOwned(1);
+        return new Node(card);
+    }
+    Node* node = spare;
+    spare = node->right;
+    spareCount--;
+    *node = Node(card);
+    return node;
+}
+
+void CardList::recycleNode(Node* node) {
+    node->right = spare;
+    spare = node;
+    spareCount++;
+}
+
+void CardList::recycleTree(Node* node) {
+    if (node == nullptr) return;
+    recycleTree(node->left);
+    Node* right = node->right;
+    recycleNode(node);
+    recycleTree(right);
+}
+
+// ====== Balancing Helpers ======
+
+int CardList::heightOf(const Node* node) {
+    return node ? node->height : 0;
+}
+
+size_t CardList::totalOf(const Node* node) {
+    return node ? node->total : 0;
+}
+
+// Recompute height and total from the children
+void CardList::update(Node* node) {
+    node->height = 1 + std::max(heightOf(node->left), heightOf(node->right));
+    node->total = node->count + totalOf(node->left) + totalOf(node->right);
+}
+
+CardList::Node* CardList::rotateLeft(Node* node) {
+    Node* pivot = node->right;
+    node->right = pivot->left;
+    if (node->right != nullptr) node->right->parent = node;
+    pivot->left = node;
+    pivot->parent = node->parent;
+    node->parent = pivot;
+    update(node);
+    update(pivot);
+    return pivot;
+}
+
+CardList::Node* CardList::rotateRight(Node* node) {
+    Node* pivot = node->left;
+    node->left = pivot->right;
+    if (node->left != nullptr) node->left->parent = node;
+    pivot->right = node;
+    pivot->parent = node->parent;
+    node->parent = pivot;
+    update(node);
+    update(pivot);
+    return pivot;
+}
+
+// Restore the AVL property at node, whose subtrees are balanced and differ in height by at most 2
+CardList::Node* CardList::rebalance(Node* node) {
+    update(node);
+    int balance = heightOf(node->left) - heightOf(node->right);
+    
+    if (balance > 1) {
+        if (heightOf(node->left->left) < heightOf(node->left->right)) {
+            node->left = rotateLeft(node->left);
+        }
+        return rotateRight(node);
+    }
+    if (balance < -1) {
+        if (heightOf(node->right->right) < heightOf(node->right->left)) {
+            node->right = rotateRight(node->right);
+        }
+        return rotateLeft(node);
+    }
+    return node;
+}
+
+// ====== Split/Join Helpers ======
+
+// Join two trees with every card in left < middle < every card in right
+CardList::Node* CardList::joinNodes(Node* left, Node* middle, Node* right) {
+    Node* root;
+    if (heightOf(left) > heightOf(right) + 1) {
+        root = joinRight(left, middle, right);
+    } else if (heightOf(right) > heightOf(left) + 1) {
+        root = joinLeft(left, middle, right);
+    } else {
+        middle->left = left;
+        middle->right = right;
+        if (left != nullptr) left->parent = middle;
+        if (right != nullptr) right->parent = middle;
+        update(middle);
+        root = middle;
+    }
+    root->parent = nullptr;
+    return root;
+}
+
+// left is the taller tree: walk down its right spine to a subtree as tall as right
+CardList::Node* CardList::joinRight(Node* left, Node* middle, Node* right) {
+    if (heightOf(left->right) <= heightOf(right) + 1) {
+        middle->left = left->right;
+        middle->right = right;
+        if (middle->left != nullptr) middle->left->parent = middle;
+        if (right != nullptr) right->parent = middle;
+        update(middle);
+        left->right = middle;
+    } else {
+        left->right = joinRight(left->right, middle, right);
+    }
+    left->right->parent = left;
+    return rebalance(left);
+}
+
+// right is the taller tree: walk down its left spine to a subtree as tall as left
+CardList::Node* CardList::joinLeft(Node* left, Node* middle, Node* right) {
+    if (heightOf(right->left) <= heightOf(left) + 1) {
+        middle->left = left;
+        middle->right = right->left;
+        if (left != nullptr) left->parent = middle;
+        if (middle->right != nullptr) middle->right->parent = middle;
+        update(middle);
+        right->left = middle;
+    } else {
+        right->left = joinLeft(left, middle, right->left);
+    }
+    right->left->parent = right;
+    return rebalance(right);
+}
+
+// Join without a middle node: the largest card of left becomes the middle
+CardList::Node* CardList::joinPair(Node* left, Node* right) {
+    if (left == nullptr) return right;
+    if (right == nullptr) return left;
+    
+    Node *less, *max, *greater;
+    splitNode(left, findMax(left)->data, less, max, greater);
+    return joinNodes(less, max, right);
+}
+
+// Split a tree into the cards below key, the node holding key (or nullptr) and the cards above it
+void CardList::splitNode(Node* node, const Card& key, Node*& less, Node*& equal, Node*& greater) {
+    if (node == nullptr) {
+        less = equal = greater = nullptr;
+        return;
+    }
+    
+    Node* left = node->left;
+    Node* right = node->right;
+    if (left != nullptr) left->parent = nullptr;
+    if (right != nullptr) right->parent = nullptr;
+    node->left = node->right = nullptr;
+    node->parent = nullptr;
+    
+    if (key < node->data) {
+        splitNode(left, key, less, equal, greater);
+        greater = joinNodes(greater, node, right);
+    } else if (node->data < key) {
+        splitNode(right, key, less, equal, greater);
+        less = joinNodes(left, node, less);
+    } else {
+        update(node);
+        less = left;
+        equal = node;
+        greater = right;
+    }
+}
+
+// ====== Set Operation Helpers ======
+
+// Run left(), right() as a pair, forking left onto another thread when allowed
+template <class Left, class Right>
+static void forkJoin(bool parallel, Left left, Right right) {
+    if (parallel) {
+        auto leftDone = std::async(std::launch::async, left);
+        right();
+        leftDone.get();
+    } else {
+        left();
+        right();
+    }
+}
+
+CardList::Node* CardList::unionNodes(Node* a, Node* b, int depth, int minHeight) {
+    if (a == nullptr) return b;
+    if (b == nullptr) return a;
+    bool parallel = depth > 0 && std::min(a->height, b->height) >= minHeight;
+    
+    // Split b around a's root and combine the halves independently
+    Node *bLess, *bEqual, *bGreater;
+    splitNode(b, a->data, bLess, bEqual, bGreater);
+    Node* aLess = a->left;
+    Node* aGreater = a->right;
+    if (aLess != nullptr) aLess->parent = nullptr;
+    if (aGreater != nullptr) aGreater->parent = nullptr;
+    if (bEqual != nullptr) {
+        a->count = std::max(a->count, bEqual->count);
+        delete bEqual;
+    }
+    
+    Node *less, *greater;
+    forkJoin(parallel,
+             [&]() { less = unionNodes(aLess, bLess, depth - 1, minHeight); },
+             [&]() { greater = unionNodes(aGreater, bGreater, depth - 1, minHeight); });
+    return joinNodes(less, a, greater);
+}
+
+CardList::Node* CardList::intersectNodes(Node* a, Node* b, int depth, int minHeight) {
+    if (a == nullptr || b == nullptr) {
+        deleteTree(a);
+        deleteTree(b);
+        return nullptr;
+    }
+    bool parallel = depth > 0 && std::min(a->height, b->height) >= minHeight;
+    
+    Node *bLess, *bEqual, *bGreater;
+    splitNode(b, a->data, bLess, bEqual, bGreater);
+    Node* aLess = a->left;
+    Node* aGreater = a->right;
+    if (aLess != nullptr) aLess->parent = nullptr;
+    if (aGreater != nullptr) aGreater->parent = nullptr;
+    
+    Node *less, *greater;
+    forkJoin(parallel,
+             [&]() { less = intersectNodes(aLess, bLess, depth - 1, minHeight); },
+             [&]() { greater = intersectNodes(aGreater, bGreater, depth - 1, minHeight); });
+    
+    if (bEqual == nullptr) {
+        delete a;
+        return joinPair(less, greater);
+    }
+    a->count = std::min(a->count, bEqual->count);
+    delete bEqual;
+    return joinNodes(less, a, greater);
+}
+
+CardList::Node* CardList::differenceNodes(Node* a, Node* b, int depth, int minHeight) {
+    if (a == nullptr || b == nullptr) {
+        deleteTree(b);
+        return a;
+    }
+    bool parallel = depth > 0 && std::min(a->height, b->height) >= minHeight;
+    
+    Node *bLess, *bEqual, *bGreater;
+    splitNode(b, a->data, bLess, bEqual, bGreater);
+    Node* aLess = a->left;
+    Node* aGreater = a->right;
+    if (aLess != nullptr) aLess->parent = nullptr;
+    if (aGreater != nullptr) aGreater->parent = nullptr;
+    
+    Node *less, *greater;
+    forkJoin(parallel,
+             [&]() { less = differenceNodes(aLess, bLess, depth - 1, minHeight); },
+             [&]() { greater = differenceNodes(aGreater, bGreater, depth - 1, minHeight); });
+    
+    size_t removed = bEqual ? bEqual->count : 0;
+    delete bEqual;
+    if (a->count <= removed) {
+        delete a;
+        return joinPair(less, greater);
+    }
+    a->count -= removed;
+    return joinNodes(less, a, greater);
+}
+
+CardList CardList::fromRoot(Node* node) {
+    CardList list;
+    list.root = node;
+    if (node != nullptr) node->parent = nullptr;
+    list.cardCount = totalOf(node);
+    list.ownedNodes = node == nullptr ? 0 : UNCOUNTED;
+    return list;
+}
+
+// Number of forking levels that keeps about threads tasks busy
+static int forkDepth(int threads) {
+    int depth = 0;
+    while (threads > 1) {
+        threads = (threads + 1) / 2;
+        depth++;
+    }
+    return depth;
+}
+
 // ====== Iterator Methods ======
 
 CardList::Iterator& CardList::Iterator::operator++() {
     if (current == nullptr) return *this;
     
+    // Next copy of the same card first
+    if (copy + 1 < current->count) {
+        copy++;
+        return *this;
+    }
+    copy = 0;
+    
     // If node has right child, successor is the minimum in right subtree
     if (current->right != nullptr) {
         Node* node = current->right;
@@ -168,8 +552,25 @@ CardList::Iterator& CardList::Iterator::operator++() {
     return *this;
 }
 
+CardList::Iterator CardList::Iterator::operator++(int) {
+    Iterator old = *this;
+    ++*this;
+    return old;
+}
+
 CardList::Iterator& CardList::Iterator::operator--() {
-    if (current == nullptr) return *this;
+    // end() steps back to the last copy of the largest card
+    if (current == nullptr) {
+        current = list ? list->findMax(list->root) : nullptr;
+        copy = current ? current->count - 1 : 0;
+        return *this;
+    }
+    
+    // Previous copy of the same card first
+    if (copy > 0) {
+        copy--;
+        return *this;
+    }
     
     // If node has left child, predecessor is the maximum in left subtree
     if (current->left != nullptr) {
@@ -187,9 +588,16 @@ CardList::Iterator& CardList::Iterator::operator--() {
             current = current->parent;
         }
     }
+    if (current != nullptr) copy = current->count - 1;
     return *this;
 }
 
+CardList::Iterator CardList::Iterator::operator--(int) {
+    Iterator old = *this;
+    --*this;
+    return old;
+}
+
 const Card& CardList::Iterator::operator*() const {
     return current->data;
 }
@@ -199,11 +607,11 @@ const Card* CardList::Iterator::operator->() const {
 }
 
 bool CardList::Iterator::operator==(const Iterator& other) const {
-    return current == other.current;
+    return current == other.current && copy == other.copy;
 }
 
 bool CardList::Iterator::operator!=(const Iterator& other) const {
-    return current != other.current;
+    return !(*this == other);
 }
 
 // ====== ReverseIterator Methods ======
@@ -211,6 +619,12 @@ bool CardList::Iterator::operator!=(const Iterator& other) const {
 CardList::ReverseIterator& CardList::ReverseIterator::operator++() {
     if (current == nullptr) return *this;
     
+    // Remaining copies of the same card first
+    if (copy > 0) {
+        copy--;
+        return *this;
+    }
+    
     // If node has left child, predecessor is the maximum in left subtree
     if (current->left != nullptr) {
         Node* node = current->left;
@@ -227,11 +641,30 @@ CardList::ReverseIterator& CardList::ReverseIterator::operator++() {
             current = current->parent;
         }
     }
+    if (current != nullptr) copy = current->count - 1;
     return *this;
 }
 
+CardList::ReverseIterator CardList::ReverseIterator::operator++(int) {
+    ReverseIterator old = *this;
+    ++*this;
+    return old;
+}
+
 CardList::ReverseIterator& CardList::ReverseIterator::operator--() {
-    if (current == nullptr) return *this;
+    // rend() steps back to the first copy of the smallest card
+    if (current == nullptr) {
+        current = list ? list->findMin(list->root) : nullptr;
+        copy = 0;
+        return *this;
+    }
+    
+    // Next copy of the same card first
+    if (copy + 1 < current->count) {
+        copy++;
+        return *this;
+    }
+    copy = 0;
     
     // If node has right child, successor is the minimum in right subtree
     if (current->right != nullptr) {
@@ -252,6 +685,12 @@ CardList::ReverseIterator& CardList::ReverseIterator::operator--() {
     return *this;
 }
 
+CardList::ReverseIterator CardList::ReverseIterator::operator--(int) {
+    ReverseIterator old = *this;
+    --*this;
+    return old;
+}
+
 const Card& CardList::ReverseIterator::operator*() const {
     return current->data;
 }
@@ -261,35 +700,73 @@ const Card* CardList::ReverseIterator::operator->() const {
 }
 
 bool CardList::ReverseIterator::operator==(const ReverseIterator& other) const {
-    return current == other.current;
+    return current == other.current && copy == other.copy;
 }
 
 bool CardList::ReverseIterator::operator!=(const ReverseIterator& other) const {
-    return current != other.current;
+    return !(*this == other);
 }
 
 // ====== CardList Methods ======
 
-CardList::CardList() : root(nullptr), size(0) {}
+CardList::CardList() : root(nullptr), cardCount(0), spare(nullptr), spareCount(0), ownedNodes(0), peakNodes(0) {}
+
+CardList::CardList(const CardList& other)
+    : root(nullptr), cardCount(other.cardCount), spare(nullptr), spareCount(0), ownedNodes(0), peakNodes(0) {
+    TRACE_SCOPE("CardList copy");
+    root = copyTree(other.root, nullptr);
+}
+
+CardList::CardList(CardList&& other) noexcept
+    : root(other.root), cardCount(other.cardCount), spare(other.spare), spareCount(other.spareCount),
+      ownedNodes(other.ownedNodes), peakNodes(other.peakNodes) {
+    other.root = nullptr;
+    other.cardCount = 0;
+    other.spare = nullptr;
+    other.spareCount = 0;
+    other.ownedNodes = 0;
+    other.peakNodes = 0;
+}
+
+CardList& CardList::operator=(CardList other) noexcept {
+    std::swap(root, other.root);
+    std::swap(cardCount, other.cardCount);
+    std::swap(spare, other.spare);
+    std::swap(spareCount, other.spareCount);
+    std::swap(ownedNodes, other.ownedNodes);
+    std::swap(peakNodes, other.peakNodes);
+    return *this;
+}
 
 CardList::~CardList() {
     deleteTree(root);
+    root = nullptr;
+    shrink();
 }
 
 void CardList::insert(const Card& card) {
     root = insertHelper(root, card, nullptr);
-    size++;
+    cardCount++;
 }
 
 CardList::Iterator CardList::find(const Card& card) const {
-    return Iterator(findHelper(root, card));
+    return Iterator(this, findHelper(root, card));
 }
 
 void CardList::erase(const Card& card) {
-    if (findHelper(root, card) != nullptr) {
+    Node* node = findHelper(root, card);
+    if (node == nullptr) return;
+    
+    // Remove one copy; the node goes only with the last one
+    if (node->count > 1) {
+        node->count--;
+        for (Node* n = node; n != nullptr; n = n->parent) {
+            n->total--;
+        }
+    } else {
         root = eraseHelper(root, card);
-        size--;
     }
+    cardCount--;
 }
 
 void CardList::erase(Iterator it) {
@@ -302,26 +779,190 @@ bool CardList::contains(const Card& card) const {
     return findHelper(root, card) != nullptr;
 }
 
+size_t CardList::count(const Card& card) const {
+    Node* node = findHelper(root, card);
+    return node ? node->count : 0;
+}
+
+void CardList::assignSorted(const Card* cards, size_t count) {
+    TRACE_SCOPE("CardList::assignSorted");
+    countOwned();
+    recycleTree(root);
+    
+    // Collapse runs of equal cards into counts so the tree has no equal keys, matching insert()
+    std::vector<Card> unique;
+    std::vector<size_t> counts;
+    unique.reserve(count);
+    counts.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        if (unique.empty() || unique.back() < cards[i]) {
+            unique.push_back(cards[i]);
+            counts.push_back(1);
+        } else {
+            counts.back()++;
+        }
+    }
+    
+    root = buildBalanced(unique.data(), counts.data(), 0, unique.size(), nullptr);
+    cardCount = count;
+}
+
+size_t CardList::erase(const Card* keys, size_t count) {
+    TRACE_SCOPE("CardList::erase bulk");
+    std::vector<Card> sorted;
+    if (!std::is_sorted(keys, keys + count)) {
+        sorted.assign(keys, keys + count);
+        std::sort(sorted.begin(), sorted.end());
+        keys = sorted.data();
+    }
+    
+    std::vector<Node*> nodes;
+    flatten(root, nodes);
+    
+    // Merge the keys against the nodes; a node left with no copies is dropped
+    size_t removed = 0;
+    size_t kept = 0;
+    size_t k = 0;
+    for (Node* node : nodes) {
+        while (k < count && keys[k] < node->data) k++;
+        size_t taken = 0;
+        while (k < count && keys[k] == node->data) {
+            if (taken < node->count) taken++;
+            k++;
+        }
+        removed += taken;
+        node->count -= taken;
+        if (node->count == 0) {
+            recycleNode(node);
+        } else {
+            nodes[kept++] = node;
+        }
+    }
+    if (removed == 0) return 0;
+    nodes.resize(kept);
+    relink(nodes, removed);
+    return removed;
+}
+
+void CardList::clear() {
+    recycleTree(root);
+    root = nullptr;
+    cardCount = 0;
+}
+
+void CardList::shrink() {
+    countOwned();
+    while (spare != nullptr) {
+        Node* next = spare->right;
+        delete spare;
+        spare = next;
+    }
+    ownedNodes -= spareCount;
+    spareCount = 0;
+}
+
+size_t CardList::spareNodes() const {
+    return spareCount;
+}
+
+size_t CardList::countNodes(const Node* node) {
+    if (node == nullptr) return 0;
+    return 1 + countNodes(node->left) + countNodes(node->right);
+}
+
+CardList::MemoryUsage CardList::memoryUsage() const {
+    MemoryUsage usage;
+    usage.cards = cardCount;
+    usage.nodes = countNodes(root);
+    usage.spareNodes = spareCount;
+    usage.peakNodes = std::max(peakNodes, usage.nodes + usage.spareNodes);
+    usage.bytes = sizeof(CardList) + (usage.nodes + usage.spareNodes) * NODE_BYTES;
+    return usage;
+}
+
+CardList CardList::split(const Card& key) {
+    TRACE_SCOPE("CardList::split");
+    Node *less, *equal, *greater;
+    splitNode(root, key, less, equal, greater);
+    
+    root = less;
+    cardCount = totalOf(less);
+    ownedNodes = UNCOUNTED;
+    return fromRoot(equal ? joinNodes(nullptr, equal, greater) : greater);
+}
+
+bool CardList::join(CardList& other) {
+    TRACE_SCOPE("CardList::join");
+    if (root != nullptr && other.root != nullptr && !(findMax(root)->data < findMin(other.root)->data)) {
+        return false;
+    }
+    
+    root = joinPair(root, other.root);
+    cardCount += other.cardCount;
+    if (ownedNodes != UNCOUNTED && other.ownedNodes != UNCOUNTED) {
+        addOwned(other.ownedNodes - other.spareCount);
+    } else {
+        ownedNodes = UNCOUNTED;
+    }
+    other.root = nullptr;
+    other.cardCount = 0;
+    other.ownedNodes = other.spareCount;
+    return true;
+}
+
+CardList CardList::setUnion(const CardList& a, const CardList& b, int threads, int minHeight) {
+    TRACE_SCOPE("CardList::setUnion");
+    CardList left(a), right(b);
+    Node* result = unionNodes(left.root, right.root, forkDepth(threads), minHeight);
+    left.root = right.root = nullptr;
+    return fromRoot(result);
+}
+
+CardList CardList::setIntersection(const CardList& a, const CardList& b, int threads, int minHeight) {
+    TRACE_SCOPE("CardList::setIntersection");
+    CardList left(a), right(b);
+    Node* result = intersectNodes(left.root, right.root, forkDepth(threads), minHeight);
+    left.root = right.root = nullptr;
+    return fromRoot(result);
+}
+
+CardList CardList::setDifference(const CardList& a, const CardList& b, int threads, int minHeight) {
+    TRACE_SCOPE("CardList::setDifference");
+    CardList left(a), right(b);
+    Node* result = differenceNodes(left.root, right.root, forkDepth(threads), minHeight);
+    left.root = right.root = nullptr;
+    return fromRoot(result);
+}
+
 CardList::Iterator CardList::begin() const {
-    return Iterator(findMin(root));
+    return Iterator(this, findMin(root));
 }
 
 CardList::Iterator CardList::end() const {
-    return Iterator(nullptr);
+    return Iterator(this, nullptr);
 }
 
 CardList::ReverseIterator CardList::rbegin() const {
-    return ReverseIterator(findMax(root));
+    Node* max = findMax(root);
+    return ReverseIterator(this, max, max ? max->count - 1 : 0);
 }
 
 CardList::ReverseIterator CardList::rend() const {
-    return ReverseIterator(nullptr);
+    return ReverseIterator(this, nullptr);
 }
 
 bool CardList::empty() const {
-    return size == 0;
+    return cardCount == 0;
 }
 
 size_t CardList::getSize() const {
-    return size;
+    return cardCount;
+}
+
+size_t CardList::size() const {
+    return cardCount;
+}
+
+int CardList::height() const {
+    return heightOf(root);
 }
\ No newline at end of file
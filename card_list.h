@@ -1,12 +1,19 @@
 // card_list.h
 // Author: Yusen Liu
 // All class declarations related to defining a BST that represents a player's hand
+// A hand may hold several copies of a card (multi-deck shoes): each node keeps a
+// count, so memory and lookups don't grow with the number of copies.
+// The tree is AVL balanced, and supports split/join and the set operations built
+// on them (optionally on several threads).
 
 #ifndef CARD_LIST_H
 #define CARD_LIST_H
 
 #include "card.h"
+#include <cstddef>
+#include <iterator>
 #include <memory>
+#include <vector>
 
 class CardList {
 private:
@@ -15,36 +22,103 @@ private:
         Node* left;
         Node* right;
         Node* parent;
+        size_t count;   // copies of data held, always >= 1
+        size_t total;   // copies held in this whole subtree
+        int height;     // 1 for a leaf
         
-        Node(const Card& c) : data(c), left(nullptr), right(nullptr), parent(nullptr) {}
+        Node(const Card& c) : data(c), left(nullptr), right(nullptr), parent(nullptr), count(1), total(1), height(1) {}
     };
     
     Node* root;
-    size_t size;
+    size_t cardCount;   // every copy counts
+    Node* spare;        // nodes freed by erase/clear/assignSorted, chained through right, reused before new
+    size_t spareCount;
+    
+    // Nodes the list holds, tree and spare, and the most it has held at once.
+    // split() and the set operations move whole subtrees without counting them,
+    // so they leave ownedNodes UNCOUNTED and the next allocation or shrink counts it.
+    size_t ownedNodes;
+    size_t peakNodes;
+    static constexpr size_t UNCOUNTED = size_t(-1);
+    void countOwned();
+    void addOwned(size_t nodes);
+    
+    // Node allocation through the spare list
+    Node* newNode(const Card& card);
+    void recycleNode(Node* node);
+    void recycleTree(Node* node);
     
     // Helper functions for tree operations
     Node* insertHelper(Node* node, const Card& card, Node* parent);
     Node* findHelper(Node* node, const Card& card) const;
-    Node* findMin(Node* node) const;
-    Node* findMax(Node* node) const;
+    static Node* findMin(Node* node);
+    static Node* findMax(Node* node);
     Node* findSuccessor(Node* node) const;
     Node* findPredecessor(Node* node) const;
     Node* eraseHelper(Node* node, const Card& card);
-    void deleteTree(Node* node);
+    Node* buildBalanced(const Card* cards, const size_t* counts, size_t lo, size_t hi, Node* parent);
+    Node* copyTree(const Node* node, Node* parent);
+    static size_t countNodes(const Node* node);
+    
+    // Bulk erase: the nodes in order, and a balanced tree relinked from the
+    // ones kept (no allocation) with removed cards taken off the count
+    static void flatten(Node* node, std::vector<Node*>& out);
+    static Node* linkBalanced(Node* const* nodes, size_t lo, size_t hi, Node* parent);
+    void relink(const std::vector<Node*>& kept, size_t removed);
+    static void deleteTree(Node* node);
+    
+    // AVL balancing. Heights and totals of a null subtree are 0.
+    static int heightOf(const Node* node);
+    static size_t totalOf(const Node* node);
+    // Rotations and rebalance return the new subtree root, which
+    // takes over the old root's parent.
+    static void update(Node* node);
+    static Node* rotateLeft(Node* node);
+    static Node* rotateRight(Node* node);
+    static Node* rebalance(Node* node);
+    
+    // Split/join on detached subtrees (the roots returned have no parent)
+    static Node* joinNodes(Node* left, Node* middle, Node* right);
+    static Node* joinRight(Node* left, Node* middle, Node* right);
+    static Node* joinLeft(Node* left, Node* middle, Node* right);
+    static Node* joinPair(Node* left, Node* right);
+    static void splitNode(Node* node, const Card& key, Node*& less, Node*& equal, Node*& greater);
+    
+    // Set operations consuming both trees; subtrees at least minHeight tall fork
+    // their left half onto another thread while depth lasts
+    static Node* unionNodes(Node* a, Node* b, int depth, int minHeight);
+    static Node* intersectNodes(Node* a, Node* b, int depth, int minHeight);
+    static Node* differenceNodes(Node* a, Node* b, int depth, int minHeight);
+    
+    // Wrap a detached tree as a list
+    static CardList fromRoot(Node* node);
     
 public:
+    // Iterators visit every copy of a card, like std::multiset. Both are standard
+    // bidirectional iterators, so CardList works with <algorithm> and std::ranges;
+    // decrementing end() (or rend()) reaches the last card (or the first).
     class Iterator {
     private:
+        const CardList* list;
         Node* current;
+        size_t copy;    // which copy of current->data, 0-based
         
     public:
-        Iterator(Node* node = nullptr) : current(node) {}
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = Card;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Card*;
+        using reference = const Card&;
+        
+        Iterator(const CardList* l = nullptr, Node* node = nullptr, size_t c = 0) : list(l), current(node), copy(c) {}
         
-        // Prefix increment (operator++)
+        // Prefix/postfix increment (operator++)
         Iterator& operator++();
+        Iterator operator++(int);
         
-        // Prefix decrement (operator--)
+        // Prefix/postfix decrement (operator--)
         Iterator& operator--();
+        Iterator operator--(int);
         
         // Dereference
         const Card& operator*() const;
@@ -59,16 +133,26 @@ public:
     
     class ReverseIterator {
     private:
+        const CardList* list;
         Node* current;
+        size_t copy;    // which copy of current->data, counting down to 0
         
     public:
-        ReverseIterator(Node* node = nullptr) : current(node) {}
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = Card;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Card*;
+        using reference = const Card&;
+        
+        ReverseIterator(const CardList* l = nullptr, Node* node = nullptr, size_t c = 0) : list(l), current(node), copy(c) {}
         
-        // Prefix increment (operator++) - goes to predecessor
+        // Prefix/postfix increment (operator++) - goes to predecessor
         ReverseIterator& operator++();
+        ReverseIterator operator++(int);
         
-        // Prefix decrement (operator--) - goes to successor
+        // Prefix/postfix decrement (operator--) - goes to successor
         ReverseIterator& operator--();
+        ReverseIterator operator--(int);
         
         // Dereference
         const Card& operator*() const;
@@ -81,16 +165,74 @@ public:
         friend class CardList;
     };
     
-    // Constructors/Destructors
+    // Constructors/Destructors (copies are deep; moves steal the tree)
     CardList();
+    CardList(const CardList& other);
+    CardList(CardList&& other) noexcept;
+    CardList& operator=(CardList other) noexcept;
     ~CardList();
     
-    // Basic operations
+    // Basic operations. insert adds one copy; erase removes one copy.
     void insert(const Card& card);
     Iterator find(const Card& card) const;
     void erase(const Card& card);
     void erase(Iterator it);
     bool contains(const Card& card) const;
+    size_t count(const Card& card) const;
+    
+    // Replace the contents with cards already in ascending order, building a
+    // perfectly balanced tree in O(n). Repeated cards become one counted node.
+    void assignSorted(const Card* cards, size_t count);
+    
+    // Bulk removal in one in-order pass and one O(n) rebuild, instead of a search
+    // and rebalance per card. eraseIf removes every copy of each card pred
+    // accepts; pred sees each distinct card once. erase(keys) removes one copy per
+    // key, so repeated keys remove more copies, like std::set_difference; keys
+    // must be ascending (others are sorted first) and ones not held are ignored.
+    // Both return the number of cards removed.
+    template <class Pred>
+    size_t eraseIf(Pred pred);
+    size_t erase(const Card* keys, size_t count);
+    
+    // Empty the list but keep its nodes for the next inserts, so a list reused
+    // game after game stops allocating once it has reached its largest size.
+    // shrink() frees the kept nodes; spareNodes() says how many there are.
+    void clear();
+    void shrink();
+    size_t spareNodes() const;
+    
+    // What the list holds in memory: tree nodes (one per distinct card, however
+    // many copies), nodes kept for reuse, the most of both it has held at once,
+    // and the bytes of tree and spare nodes plus the list itself. Walks the
+    // tree, O(n).
+    struct MemoryUsage {
+        size_t cards;
+        size_t nodes;
+        size_t spareNodes;
+        size_t peakNodes;
+        size_t bytes;
+        
+        double bytesPerCard() const { return cards == 0 ? 0 : double(bytes) / cards; }
+    };
+    MemoryUsage memoryUsage() const;
+    static constexpr size_t NODE_BYTES = sizeof(Node);
+    
+    // Split and join, both O(log n). split keeps the cards below key and returns
+    // the cards from key on. join appends other, which must only hold cards
+    // greater than all of this list's, and leaves it empty; it returns false and
+    // changes nothing otherwise.
+    CardList split(const Card& key);
+    bool join(CardList& other);
+    
+    // Set operations with the multiset semantics of std::set_union (most copies),
+    // std::set_intersection (fewest) and std::set_difference (copies left after
+    // removing b's), giving the same list as those algorithms. The inputs are
+    // untouched. With threads > 1 the divide-and-conquer recursion runs on up to
+    // that many threads, for subtrees at least minHeight tall.
+    static constexpr int PARALLEL_MIN_HEIGHT = 10;
+    static CardList setUnion(const CardList& a, const CardList& b, int threads = 1, int minHeight = PARALLEL_MIN_HEIGHT);
+    static CardList setIntersection(const CardList& a, const CardList& b, int threads = 1, int minHeight = PARALLEL_MIN_HEIGHT);
+    static CardList setDifference(const CardList& a, const CardList& b, int threads = 1, int minHeight = PARALLEL_MIN_HEIGHT);
     
     // Iterator support
     Iterator begin() const;
@@ -101,6 +243,41 @@ public:
     // Utility
     bool empty() const;
     size_t getSize() const;
+    size_t size() const;    // same as getSize(), for std::ranges::size
+    int height() const;     // 0 when empty
 };
 
+template <class Pred>
+size_t CardList::eraseIf(Pred pred) {
+    std::vector<Node*> nodes;
+    flatten(root, nodes);
+    
+    // Decide for every node before touching any, so a throwing pred leaves the list as it was
+    std::vector<bool> drop(nodes.size());
+    for (size_t i = 0; i < nodes.size(); i++) {
+        drop[i] = bool(pred(static_cast<const Card&>(nodes[i]->data)));
+    }
+    
+    size_t removed = 0;
+    size_t kept = 0;
+    for (size_t i = 0; i < nodes.size(); i++) {
+        if (drop[i]) {
+            removed += nodes[i]->count;
+            recycleNode(nodes[i]);
+        } else {
+            nodes[kept++] = nodes[i];
+        }
+    }
+    if (removed == 0) return 0;
+    nodes.resize(kept);
+    relink(nodes, removed);
+    return removed;
+}
+
+// Same as list.eraseIf(pred), in the form of std::erase_if for standard containers
+template <class Pred>
+size_t erase_if(CardList& list, Pred pred) {
+    return list.eraseIf(pred);
+}
+
 #endif
@@ -0,0 +1,206 @@
+// checkpoint.cpp
+// Author: Yusen Liu
+// Implementation of the functions and classes declared in checkpoint.h
+
+#include "checkpoint.h"
+#include "trace.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ====== Helper Functions ======
+
+static void putLittle(uint8_t* out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out[i] = uint8_t(value >> (8 * i));
+    }
+}
+
+static uint64_t getLittle(const uint8_t* in, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value |= uint64_t(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+static uint32_t fnv1a(const uint8_t* data, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// fsync the directory holding path, so a rename in it is durable
+static void syncDirectory(const std::string& path) {
+    size_t slash = path.rfind('/');
+    std::string dir = slash == std::string::npos ? "." : path.substr(0, slash + 1);
+    int fd = ::open(dir.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        fsync(fd);
+        ::close(fd);
+    }
+}
+
+// ====== Checkpoint Files ======
+
+bool writeCheckpoint(const std::string& path, const StreamProgress& progress) {
+    TRACE_SCOPE("write checkpoint");
+    uint8_t data[CHECKPOINT_SIZE];
+    memcpy(data, "GCKP", 4);
+    putLittle(data + 4, CHECKPOINT_VERSION, 4);
+    putLittle(data + 8, progress.inputOffset, 8);
+    putLittle(data + 16, progress.outputOffset, 8);
+    putLittle(data + 24, progress.games, 8);
+    putLittle(data + 32, fnv1a(data, 32), 4);
+
+    std::string tmp = path + ".tmp";
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    bool ok = write(fd, data, CHECKPOINT_SIZE) == ssize_t(CHECKPOINT_SIZE) && fsync(fd) == 0;
+    ok = ::close(fd) == 0 && ok;
+    if (!ok || rename(tmp.c_str(), path.c_str()) != 0) {
+        unlink(tmp.c_str());
+        return false;
+    }
+    syncDirectory(path);
+    return true;
+}
+
+bool readCheckpoint(const std::string& path, StreamProgress& progress) {
+    std::ifstream file(path, std::ios::binary);
+    uint8_t data[CHECKPOINT_SIZE];
+    if (!file.read((char*)data, CHECKPOINT_SIZE)) return false;
+    if (memcmp(data, "GCKP", 4) != 0 || getLittle(data + 4, 4) != CHECKPOINT_VERSION) return false;
+    if (getLittle(data + 32, 4) != fnv1a(data, 32)) return false;
+    progress.inputOffset = getLittle(data + 8, 8);
+    progress.outputOffset = getLittle(data + 16, 8);
+    progress.games = getLittle(data + 24, 8);
+    return true;
+}
+
+// ====== CheckpointWriter Methods ======
+
+CheckpointWriter::CheckpointWriter(const std::string& checkpointPath, const std::string& outputPath)
+    : path(checkpointPath), outputFd(::open(outputPath.c_str(), O_WRONLY)),
+      pending(false), stopping(false), failed(false) {
+    worker = std::thread([this]() { run(); });
+}
+
+CheckpointWriter::~CheckpointWriter() {
+    finish();
+}
+
+void CheckpointWriter::run() {
+    traceThreadName("checkpoint");
+    std::unique_lock<std::mutex> guard(lock);
+    while (true) {
+        wake.wait(guard, [this]() { return pending || stopping; });
+        if (!pending) break;
+        StreamProgress progress = latest;
+        pending = false;
+        guard.unlock();
+
+        // Output first: the checkpoint may only point at output that is on disk
+        bool ok = outputFd >= 0 && fdatasync(outputFd) == 0 && writeCheckpoint(path, progress);
+
+        guard.lock();
+        failed = failed || !ok;
+    }
+}
+
+void CheckpointWriter::post(const StreamProgress& progress) {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        latest = progress;
+        pending = true;
+    }
+    wake.notify_one();
+}
+
+bool CheckpointWriter::finish() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_one();
+    if (worker.joinable()) worker.join();
+    if (outputFd >= 0) {
+        ::close(outputFd);
+        outputFd = -1;
+    }
+    return !failed;
+}
+
+// ====== Batch Runs ======
+
+bool runBatch(const BatchOptions& options, std::string& error) {
+    StreamProgress start;
+    if (options.resume && !options.checkpoint.empty() && access(options.checkpoint.c_str(), F_OK) == 0) {
+        if (!readCheckpoint(options.checkpoint, start)) {
+            error = "Checkpoint " + options.checkpoint + " is corrupt";
+            return false;
+        }
+        // Drop output written after the checkpoint; it will be written again
+        struct stat info;
+        if (stat(options.output.c_str(), &info) != 0 || uint64_t(info.st_size) < start.outputOffset) {
+            error = "Output " + options.output + " is shorter than its checkpoint";
+            return false;
+        }
+        if (truncate(options.output.c_str(), off_t(start.outputOffset)) != 0) {
+            error = "Could not truncate " + options.output;
+            return false;
+        }
+    }
+
+    std::ifstream in(options.input, std::ios::binary);
+    if (in.fail()) {
+        error = "Could not open file " + options.input;
+        return false;
+    }
+    in.seekg(std::streamoff(start.inputOffset));
+    std::ofstream out(options.output, std::ios::binary | (start.games > 0 ? std::ios::app : std::ios::trunc));
+    if (out.fail()) {
+        error = "Could not open file " + options.output;
+        return false;
+    }
+
+    const std::string rejected = "Stopped at a bad card in " + options.input;
+    if (options.checkpoint.empty()) {
+        bool played = runStream(in, out, options.threads, options.fast, start, nullptr, options.policy);
+        out.flush();
+        if (!played) error = rejected;
+        return played && bool(out);
+    }
+
+    CheckpointWriter checkpoints(options.checkpoint, options.output);
+    size_t every = std::max<size_t>(options.checkpointEvery, 1);
+    StreamProgress last = start;
+    bool played = runStream(in, out, options.threads, options.fast, start, [&](const StreamProgress& progress) {
+        last = progress;
+        if (progress.games % every == 0) {
+            out.flush();
+            checkpoints.post(progress);
+        }
+    }, options.policy);
+
+    // A final checkpoint at the end of the input makes a repeated resume a no-op
+    // (or, after a rejected game, points just before it)
+    out.flush();
+    if (!out) {
+        error = "Could not write file " + options.output;
+        return false;
+    }
+    checkpoints.post(last);
+    if (!checkpoints.finish()) {
+        error = "Could not write checkpoint " + options.checkpoint;
+        return false;
+    }
+    if (!played) error = rejected;
+    return played;
+}
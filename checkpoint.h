@@ -0,0 +1,90 @@
+// checkpoint.h
+// Author: Yusen Liu
+// Checkpoints for long stream runs, so a killed run can resume where it stopped.
+//
+// A checkpoint is a StreamProgress: the input offset up to which every game has
+// been played, the length of output those games produced, and the game count.
+// Games after the cursor are simply read and played again on resume, which
+// gives the same output because the game is deterministic.
+//
+// Checkpoint file layout (little-endian, 36 bytes):
+//   0  char[4]  magic "GCKP"
+//   4  uint32   version (1)
+//   8  uint64   input offset
+//   16 uint64   output offset
+//   24 uint64   games written
+//   32 uint32   FNV-1a hash of bytes 0..31
+//
+// Files are replaced atomically: written to path.tmp, fsynced, then renamed over
+// path, so a crash leaves either the old checkpoint or the new one.
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "stream_game.h"
+
+const uint32_t CHECKPOINT_VERSION = 1;
+const size_t CHECKPOINT_SIZE = 36;
+
+// Write or read one checkpoint file. Reading fails on a missing file, a bad
+// magic, version or hash.
+bool writeCheckpoint(const std::string& path, const StreamProgress& progress);
+bool readCheckpoint(const std::string& path, StreamProgress& progress);
+
+// Writes checkpoints on its own thread so the stream never waits on the disk.
+// Before each checkpoint the output file is fsynced, so a checkpoint never
+// claims output that could still be lost. Only the latest posted progress is
+// kept; if the disk is slower than the posts, intermediate ones are skipped.
+class CheckpointWriter {
+private:
+    std::string path;
+    int outputFd;               // for fsync of the output, -1 if it can't be opened
+    std::mutex lock;
+    std::condition_variable wake;
+    StreamProgress latest;
+    bool pending;
+    bool stopping;
+    bool failed;
+    std::thread worker;
+
+    void run();
+
+public:
+    CheckpointWriter(const std::string& checkpointPath, const std::string& outputPath);
+    ~CheckpointWriter();
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    // Queue a checkpoint. The output stream must already be flushed up to
+    // progress.outputOffset. Never blocks on I/O.
+    void post(const StreamProgress& progress);
+
+    // Write whatever is still queued and stop. False if any write failed.
+    bool finish();
+};
+
+// A batch run of the stream format from one file to another
+struct BatchOptions {
+    std::string input;
+    std::string output;
+    std::string checkpoint;     // none if empty
+    bool resume = false;        // continue from the checkpoint, if there is one
+    size_t checkpointEvery = 10000;     // games between checkpoints
+    int threads = 1;
+    bool fast = false;
+    BadCardPolicy policy = REJECT_BAD_CARDS;    // reject stops the run at the first bad game
+};
+
+// Play every game in options.input into options.output. With resume and an
+// existing checkpoint, the output is cut back to the checkpoint and the run
+// picks up at its input offset, so the finished output is the same as an
+// uninterrupted run's. Returns false with a message in error on failure; a
+// rejected bad card leaves the output and checkpoint at the game before it, so
+// once the input is fixed --resume carries on from there.
+bool runBatch(const BatchOptions& options, std::string& error);
+
+#endif
@@ -0,0 +1,117 @@
+// concurrent_card_set.cpp
+// Author: Yusen Liu
+// Implementation of the classes defined in concurrent_card_set.h
+
+#include "concurrent_card_set.h"
+
+// ====== Helper Functions ======
+
+// Bit for a card, or 0 for a card that is not in the standard deck
+uint64_t ConcurrentCardSet::bitFor(const Card& card) {
+    int code = card.toCode();
+    if (code < 0) return 0;
+    return uint64_t(1) << code;
+}
+
+// First set bit at or above position, 64 if none
+static int nextCode(uint64_t bits, int from) {
+    if (from >= 64) return 64;
+    bits &= ~uint64_t(0) << from;
+    return bits ? __builtin_ctzll(bits) : 64;
+}
+
+// Last set bit at or below position, -1 if none
+static int prevCode(uint64_t bits, int from) {
+    if (from < 0) return -1;
+    if (from < 63) bits &= (uint64_t(1) << (from + 1)) - 1;
+    return bits ? 63 - __builtin_clzll(bits) : -1;
+}
+
+// ====== Iterator Methods ======
+
+ConcurrentCardSet::Iterator& ConcurrentCardSet::Iterator::operator++() {
+    if (code >= 64) return *this;
+    code = nextCode(set->snapshot(), code + 1);
+    return *this;
+}
+
+Card ConcurrentCardSet::Iterator::operator*() const {
+    return Card::fromCode(code);
+}
+
+bool ConcurrentCardSet::Iterator::operator==(const Iterator& other) const {
+    return code == other.code;
+}
+
+bool ConcurrentCardSet::Iterator::operator!=(const Iterator& other) const {
+    return code != other.code;
+}
+
+// ====== ReverseIterator Methods ======
+
+ConcurrentCardSet::ReverseIterator& ConcurrentCardSet::ReverseIterator::operator++() {
+    if (code < 0) return *this;
+    code = prevCode(set->snapshot(), code - 1);
+    return *this;
+}
+
+Card ConcurrentCardSet::ReverseIterator::operator*() const {
+    return Card::fromCode(code);
+}
+
+bool ConcurrentCardSet::ReverseIterator::operator==(const ReverseIterator& other) const {
+    return code == other.code;
+}
+
+bool ConcurrentCardSet::ReverseIterator::operator!=(const ReverseIterator& other) const {
+    return code != other.code;
+}
+
+// ====== ConcurrentCardSet Methods ======
+
+ConcurrentCardSet::ConcurrentCardSet() : bits(0) {}
+
+bool ConcurrentCardSet::insert(const Card& card) {
+    uint64_t bit = bitFor(card);
+    if (bit == 0) return false;
+    return (bits.fetch_or(bit) & bit) == 0;
+}
+
+bool ConcurrentCardSet::erase(const Card& card) {
+    uint64_t bit = bitFor(card);
+    if (bit == 0) return false;
+    return (bits.fetch_and(~bit) & bit) != 0;
+}
+
+bool ConcurrentCardSet::contains(const Card& card) const {
+    uint64_t bit = bitFor(card);
+    return (bits.load() & bit) != 0;
+}
+
+uint64_t ConcurrentCardSet::snapshot() const {
+    return bits.load();
+}
+
+ConcurrentCardSet::Iterator ConcurrentCardSet::begin() const {
+    return Iterator(this, nextCode(snapshot(), 0));
+}
+
+ConcurrentCardSet::Iterator ConcurrentCardSet::end() const {
+    return Iterator(this, 64);
+}
+
+ConcurrentCardSet::ReverseIterator ConcurrentCardSet::rbegin() const {
+    return ReverseIterator(this, prevCode(snapshot(), 63));
+}
+
+ConcurrentCardSet::ReverseIterator ConcurrentCardSet::rend() const {
+    return ReverseIterator(this, -1);
+}
+
+bool ConcurrentCardSet::empty() const {
+    return snapshot() == 0;
+}
+
+size_t ConcurrentCardSet::getSize() const {
+    return __builtin_popcountll(snapshot());
+}
@@ -0,0 +1,87 @@
+// concurrent_card_set.h
+// Author: Yusen Liu
+// Lock-free set of cards from a single standard deck, shared between threads.
+// The whole deck fits in one 64-bit word (bit i = card code i), so insert and
+// erase are a single atomic fetch_or/fetch_and and every operation is linearizable.
+
+#ifndef CONCURRENT_CARD_SET_H
+#define CONCURRENT_CARD_SET_H
+
+#include "card.h"
+#include <atomic>
+#include <cstdint>
+
+class ConcurrentCardSet {
+private:
+    std::atomic<uint64_t> bits;
+
+    static uint64_t bitFor(const Card& card);
+
+public:
+    // Ordered iterators are weakly consistent: each step re-reads the live set, so
+    // they never return a card twice or out of order, and they see changes made
+    // ahead of their position but not behind it. Use snapshot() for a consistent view.
+    class Iterator {
+    private:
+        const ConcurrentCardSet* set;
+        int code;   // current card code, 64 at end
+
+    public:
+        Iterator(const ConcurrentCardSet* s = nullptr, int c = 64) : set(s), code(c) {}
+
+        // Prefix increment (operator++)
+        Iterator& operator++();
+
+        // Dereference (cards are built on the fly, so this returns by value)
+        Card operator*() const;
+
+        // Equality/inequality
+        bool operator==(const Iterator& other) const;
+        bool operator!=(const Iterator& other) const;
+    };
+
+    class ReverseIterator {
+    private:
+        const ConcurrentCardSet* set;
+        int code;   // current card code, -1 at end
+
+    public:
+        ReverseIterator(const ConcurrentCardSet* s = nullptr, int c = -1) : set(s), code(c) {}
+
+        // Prefix increment (operator++) - goes to predecessor
+        ReverseIterator& operator++();
+
+        // Dereference
+        Card operator*() const;
+
+        // Equality/inequality
+        bool operator==(const ReverseIterator& other) const;
+        bool operator!=(const ReverseIterator& other) const;
+    };
+
+    // Constructors
+    ConcurrentCardSet();
+    ConcurrentCardSet(const ConcurrentCardSet&) = delete;
+    ConcurrentCardSet& operator=(const ConcurrentCardSet&) = delete;
+
+    // Basic operations. insert/erase return true only for the thread whose call
+    // actually changed the set. Cards outside the standard deck are never stored.
+    bool insert(const Card& card);
+    bool erase(const Card& card);
+    bool contains(const Card& card) const;
+
+    // Atomic view of the whole set (bit i = card code i)
+    uint64_t snapshot() const;
+
+    // Iterator support
+    Iterator begin() const;
+    Iterator end() const;
+    ReverseIterator rbegin() const;
+    ReverseIterator rend() const;
+
+    // Utility
+    bool empty() const;
+    size_t getSize() const;
+};
+
+#endif
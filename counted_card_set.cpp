@@ -0,0 +1,148 @@
+// counted_card_set.cpp
+// Author: Yusen Liu
+// Implementation of the classes defined in counted_card_set.h
+
+#include "counted_card_set.h"
+
+// ====== Helper Functions ======
+
+size_t CountedCardSet::countOf(int code) const {
+    return (counters[code / 16] >> ((code % 16) * 4)) & 0xF;
+}
+
+void CountedCardSet::setCount(int code, size_t count) {
+    int shift = (code % 16) * 4;
+    counters[code / 16] = (counters[code / 16] & ~(uint64_t(0xF) << shift)) | (uint64_t(count) << shift);
+    if (count > 0) {
+        occupied |= uint64_t(1) << code;
+    } else {
+        occupied &= ~(uint64_t(1) << code);
+    }
+}
+
+// First occupied code at or above from, 64 if none
+static int nextCode(uint64_t bits, int from) {
+    if (from >= 64) return 64;
+    bits &= ~uint64_t(0) << from;
+    return bits ? __builtin_ctzll(bits) : 64;
+}
+
+// Last occupied code at or below from, -1 if none
+static int prevCode(uint64_t bits, int from) {
+    if (from < 0) return -1;
+    if (from < 63) bits &= (uint64_t(1) << (from + 1)) - 1;
+    return bits ? 63 - __builtin_clzll(bits) : -1;
+}
+
+// ====== Iterator Methods ======
+
+CountedCardSet::Iterator& CountedCardSet::Iterator::operator++() {
+    if (code >= 64) return *this;
+    if (copy + 1 < set->countOf(code)) {
+        copy++;
+    } else {
+        code = nextCode(set->occupied, code + 1);
+        copy = 0;
+    }
+    return *this;
+}
+
+Card CountedCardSet::Iterator::operator*() const {
+    return Card::fromCode(code);
+}
+
+bool CountedCardSet::Iterator::operator==(const Iterator& other) const {
+    return code == other.code && copy == other.copy;
+}
+
+bool CountedCardSet::Iterator::operator!=(const Iterator& other) const {
+    return !(*this == other);
+}
+
+// ====== ReverseIterator Methods ======
+
+CountedCardSet::ReverseIterator& CountedCardSet::ReverseIterator::operator++() {
+    if (code < 0) return *this;
+    if (copy > 0) {
+        copy--;
+    } else {
+        code = prevCode(set->occupied, code - 1);
+        copy = code >= 0 ? set->countOf(code) - 1 : 0;
+    }
+    return *this;
+}
+
+Card CountedCardSet::ReverseIterator::operator*() const {
+    return Card::fromCode(code);
+}
+
+bool CountedCardSet::ReverseIterator::operator==(const ReverseIterator& other) const {
+    return code == other.code && copy == other.copy;
+}
+
+bool CountedCardSet::ReverseIterator::operator!=(const ReverseIterator& other) const {
+    return !(*this == other);
+}
+
+// ====== CountedCardSet Methods ======
+
+CountedCardSet::CountedCardSet() : counters{0, 0, 0, 0}, occupied(0), size(0) {}
+
+bool CountedCardSet::insert(const Card& card) {
+    int code = card.toCode();
+    if (code < 0) return false;
+    size_t count = countOf(code);
+    if (count == MAX_COPIES) return false;
+    setCount(code, count + 1);
+    size++;
+    return true;
+}
+
+bool CountedCardSet::erase(const Card& card) {
+    int code = card.toCode();
+    if (code < 0) return false;
+    size_t count = countOf(code);
+    if (count == 0) return false;
+    setCount(code, count - 1);
+    size--;
+    return true;
+}
+
+bool CountedCardSet::contains(const Card& card) const {
+    int code = card.toCode();
+    return code >= 0 && ((occupied >> code) & 1);
+}
+
+size_t CountedCardSet::count(const Card& card) const {
+    int code = card.toCode();
+    return code >= 0 ? countOf(code) : 0;
+}
+
+uint64_t CountedCardSet::sharedWith(const CountedCardSet& other) const {
+    return occupied & other.occupied;
+}
+
+CountedCardSet::Iterator CountedCardSet::begin() const {
+    return Iterator(this, nextCode(occupied, 0), 0);
+}
+
+CountedCardSet::Iterator CountedCardSet::end() const {
+    return Iterator(this, 64, 0);
+}
+
+CountedCardSet::ReverseIterator CountedCardSet::rbegin() const {
+    int code = prevCode(occupied, 63);
+    return ReverseIterator(this, code, code >= 0 ? countOf(code) - 1 : 0);
+}
+
+CountedCardSet::ReverseIterator CountedCardSet::rend() const {
+    return ReverseIterator(this, -1, 0);
+}
+
+bool CountedCardSet::empty() const {
+    return size == 0;
+}
+
+size_t CountedCardSet::getSize() const {
+    return size;
+}
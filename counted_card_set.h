@@ -0,0 +1,91 @@
+// counted_card_set.h
+// Author: Yusen Liu
+// Fixed-size hand for a shoe of up to 8 decks: a 4-bit copy counter per card
+// (52 counters packed into four 64-bit words) plus a 64-bit occupancy mask.
+// Every operation is O(1) and the hand is 48 bytes however many copies it holds.
+
+#ifndef COUNTED_CARD_SET_H
+#define COUNTED_CARD_SET_H
+
+#include "card.h"
+#include <cstdint>
+
+class CountedCardSet {
+public:
+    static constexpr size_t MAX_COPIES = 15;
+
+private:
+    uint64_t counters[4];   // counter for code i is 4 bits at (i % 16) * 4 in word i / 16
+    uint64_t occupied;      // bit i set when card code i has at least one copy
+    size_t size;
+
+    size_t countOf(int code) const;
+    void setCount(int code, size_t count);
+
+public:
+    // Iterators visit every copy, in card order
+    class Iterator {
+    private:
+        const CountedCardSet* set;
+        int code;       // 64 at end
+        size_t copy;
+
+    public:
+        Iterator(const CountedCardSet* s = nullptr, int c = 64, size_t cp = 0) : set(s), code(c), copy(cp) {}
+
+        // Prefix increment (operator++)
+        Iterator& operator++();
+
+        // Dereference (cards are built on the fly, so this returns by value)
+        Card operator*() const;
+
+        // Equality/inequality
+        bool operator==(const Iterator& other) const;
+        bool operator!=(const Iterator& other) const;
+    };
+
+    class ReverseIterator {
+    private:
+        const CountedCardSet* set;
+        int code;       // -1 at end
+        size_t copy;
+
+    public:
+        ReverseIterator(const CountedCardSet* s = nullptr, int c = -1, size_t cp = 0) : set(s), code(c), copy(cp) {}
+
+        // Prefix increment (operator++) - goes to predecessor
+        ReverseIterator& operator++();
+
+        // Dereference
+        Card operator*() const;
+
+        // Equality/inequality
+        bool operator==(const ReverseIterator& other) const;
+        bool operator!=(const ReverseIterator& other) const;
+    };
+
+    // Constructors
+    CountedCardSet();
+
+    // Basic operations. insert adds one copy and fails for a card outside the
+    // standard deck or one already at MAX_COPIES; erase removes one copy.
+    bool insert(const Card& card);
+    bool erase(const Card& card);
+    bool contains(const Card& card) const;
+    size_t count(const Card& card) const;
+
+    // Cards (one bit per code) both hands hold at least one copy of
+    uint64_t sharedWith(const CountedCardSet& other) const;
+
+    // Iterator support
+    Iterator begin() const;
+    Iterator end() const;
+    ReverseIterator rbegin() const;
+    ReverseIterator rend() const;
+
+    // Utility
+    bool empty() const;
+    size_t getSize() const;
+};
+
+#endif
@@ -0,0 +1,191 @@
+// fuzz_game.cpp
+// Author: Yusen Liu
+// In-process differential fuzzer: plays random hand pairs on the CardList engine
+// (playGame), the suit-partitioned engine, the std::set engine (playSetGame) and
+// the closed-form outcome (playFast) and diffs their output. Any mismatch is shrunk to a minimal pair of
+// hands and saved as fuzz_failure_<n>_a.txt / fuzz_failure_<n>_b.txt.
+// Usage: ./fuzz_game [games] [seed]
+
+#include <iostream>
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <fstream>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "card.h"
+#include "card_list.h"
+#include "game.h"
+#include "game_outcome.h"
+#include "set_game.h"
+
+using namespace std;
+
+// Shapes of input the fuzzer mixes; plain random pairs rarely hit the edges
+enum HandShape { RANDOM, EMPTY, WHOLE_DECK, DISJOINT, IDENTICAL, SORTED, REVERSED, MULTI_DECK, SHAPE_COUNT };
+
+static vector<Card> randomHand(mt19937& rng, int percent) {
+  vector<Card> hand;
+  for (int code = 0; code < 52; code++) {
+    if (int(rng() % 100) < percent) hand.push_back(Card::fromCode(code));
+  }
+  shuffle(hand.begin(), hand.end(), rng);
+  return hand;
+}
+
+static void makeHands(mt19937& rng, vector<Card>& a, vector<Card>& b) {
+  HandShape shape = HandShape(rng() % SHAPE_COUNT);
+  a = randomHand(rng, rng() % 101);
+  b = randomHand(rng, rng() % 101);
+
+  switch (shape) {
+    case EMPTY:
+      // One or both hands empty
+      if (rng() & 1) {
+        a.clear();
+        if (rng() & 1) b.clear();
+      } else {
+        b.clear();
+      }
+      break;
+    case WHOLE_DECK:
+      a = randomHand(rng, 100);
+      if (rng() & 1) b = randomHand(rng, 100);
+      break;
+    case DISJOINT: {
+      // Split one random hand between the players
+      vector<Card> pool = randomHand(rng, rng() % 101);
+      a.clear();
+      b.clear();
+      for (const Card& c : pool) {
+        if (rng() & 1) a.push_back(c); else b.push_back(c);
+      }
+      break;
+    }
+    case IDENTICAL:
+      b = a;
+      shuffle(b.begin(), b.end(), rng);
+      break;
+    case SORTED:
+      // Ascending inserts rebalance CardList at almost every step
+      sort(a.begin(), a.end());
+      sort(b.begin(), b.end());
+      break;
+    case REVERSED:
+      sort(a.rbegin(), a.rend());
+      sort(b.rbegin(), b.rend());
+      break;
+    case MULTI_DECK: {
+      // Hands drawn from a shoe of up to 8 decks, so cards repeat
+      int decks = 2 + rng() % 7;
+      for (vector<Card>* hand : {&a, &b}) {
+        hand->clear();
+        int cards = rng() % (52 * decks / 2 + 1);
+        for (int i = 0; i < cards; i++) hand->push_back(Card::fromCode(rng() % 52));
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+// Run every engine on one pair; returns true if all outputs agree
+static bool enginesAgree(const vector<Card>& a, const vector<Card>& b, string* report) {
+  CardList listA, listB;
+  SuitedCardList suitedA, suitedB;
+  multiset<Card> setA, setB;
+  for (const Card& c : a) { listA.insert(c); suitedA.insert(c); setA.insert(c); }
+  for (const Card& c : b) { listB.insert(c); suitedB.insert(c); setB.insert(c); }
+
+  // playFast only reads the hands, so it runs before the engines empty them
+  ostringstream fast, list, suited, sorted;
+  playFast(setA, setB, fast);
+  playGame(listA, listB, list);
+  playGame(suitedA, suitedB, suited);
+  playSetGame(setA, setB, sorted);
+
+  if (list.str() == sorted.str() && list.str() == fast.str() && list.str() == suited.str()) return true;
+  if (report != nullptr) {
+    *report = "--- game (CardList) ---\n" + list.str() +
+              "--- SuitedCardList ---\n" + suited.str() +
+              "--- game_set (std::multiset) ---\n" + sorted.str() +
+              "--- --fast ---\n" + fast.str();
+  }
+  return false;
+}
+
+// Greedy shrink: drop single cards while the engines still disagree
+static void minimize(vector<Card>& a, vector<Card>& b) {
+  bool shrunk = true;
+  while (shrunk) {
+    shrunk = false;
+    for (vector<Card>* hand : {&a, &b}) {
+      for (size_t i = 0; i < hand->size(); ) {
+        Card removed = (*hand)[i];
+        hand->erase(hand->begin() + i);
+        if (!enginesAgree(a, b, nullptr)) {
+          shrunk = true;
+        } else {
+          hand->insert(hand->begin() + i, removed);
+          i++;
+        }
+      }
+    }
+  }
+}
+
+static void saveHand(const string& path, const vector<Card>& hand) {
+  ofstream out(path);
+  for (const Card& c : hand) {
+    out << c << endl;
+  }
+}
+
+// Parse a whole argument as a number; false on anything else
+template <class T>
+static bool parseNumber(const char* text, T& value) {
+  const char* end = text + string(text).size();
+  auto [ptr, error] = from_chars(text, end, value);
+  return error == errc() && ptr == end && ptr != text;
+}
+
+int main(int argv, char** argc) {
+  long games = 1000000;
+  unsigned seed = random_device()();
+  if (argv > 3 || (argv > 1 && (!parseNumber(argc[1], games) || games < 0))
+      || (argv > 2 && !parseNumber(argc[2], seed))) {
+    cout << "Usage: fuzz_game [games] [seed]" << endl;
+    return 1;
+  }
+
+  cout << "Fuzzing " << games << " games, seed " << seed << endl;
+  mt19937 rng(seed);
+  int failures = 0;
+  auto start = chrono::steady_clock::now();
+
+  vector<Card> a, b;
+  for (long game = 1; game <= games; game++) {
+    makeHands(rng, a, b);
+    if (!enginesAgree(a, b, nullptr)) {
+      minimize(a, b);
+      string prefix = "fuzz_failure_" + to_string(failures++);
+      saveHand(prefix + "_a.txt", a);
+      saveHand(prefix + "_b.txt", b);
+      string report;
+      enginesAgree(a, b, &report);
+      cout << "MISMATCH in game " << game << ", minimized input saved to " << prefix << "_{a,b}.txt" << endl;
+      cout << report;
+    }
+
+    if (game % 100000 == 0 || game == games) {
+      double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+      cout << game << " games, " << failures << " mismatches, " << game / seconds << " games/s" << endl;
+    }
+  }
+
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,105 @@
+// game.cpp
+// Author: Yusen Liu
+// Implementation of the game declared in game.h
+
+#include "game.h"
+#include "game_outcome.h"
+#include "intersect.h"
+#include "trace.h"
+
+Generator<Pick> play(CardList& alice, CardList& bob) {
+  // Alternate Alice (forward) then Bob (reverse)
+  while (true) {
+    bool picked = false;
+
+    // Alice's turn: iterate from smallest to largest
+    for (auto it = alice.begin(); it != alice.end(); ++it) {
+      if (bob.contains(*it)) {
+        Card match = *it;
+        alice.erase(it);
+        bob.erase(match);
+        picked = true;
+        Pick pick{ALICE, match};
+        co_yield pick;
+        break;
+      }
+    }
+
+    // Bob's turn: iterate from largest to smallest (always runs after Alice)
+    for (auto rit = bob.rbegin(); rit != bob.rend(); ++rit) {
+      if (alice.contains(*rit)) {
+        Card match = *rit;
+        bob.erase(match);
+        alice.erase(match);
+        picked = true;
+        Pick pick{BOB, match};
+        co_yield pick;
+        break;
+      }
+    }
+
+    if (!picked) break; // no more matches
+  }
+}
+
+void playGame(CardList& alice, CardList& bob, std::ostream& out, std::vector<Pick>* picks) {
+  {
+    TRACE_SCOPE("match loop");
+    for (const Pick& pick : play(alice, bob)) {
+      out << (pick.player == ALICE ? "Alice" : "Bob") << " picked matching card " << pick.card << std::endl;
+      if (picks) picks->push_back(pick);
+    }
+  }
+
+  printHands(alice, bob, out);
+}
+
+void playGame(SuitedCardList& alice, SuitedCardList& bob, std::ostream& out) {
+  {
+    TRACE_SCOPE("match loop");
+    while (true) {
+      bool picked = false;
+
+      // Alice's turn: her smallest card Bob also holds
+      auto first = alice.firstShared(bob);
+      if (first != alice.end()) {
+        Card match = *first;
+        out << "Alice picked matching card " << match << std::endl;
+        alice.erase(match);
+        bob.erase(match);
+        picked = true;
+      }
+
+      // Bob's turn: his largest card Alice also holds (always runs after Alice)
+      auto last = bob.lastShared(alice);
+      if (last != bob.rend()) {
+        Card match = *last;
+        out << "Bob picked matching card " << match << std::endl;
+        bob.erase(match);
+        alice.erase(match);
+        picked = true;
+      }
+
+      if (!picked) break; // no more matches
+    }
+  }
+
+  printHands(alice, bob, out);
+}
+
+void playFastPacked(const std::vector<uint16_t>& alice, const std::vector<uint16_t>& bob, std::ostream& out) {
+  TRACE_SCOPE("fast outcome");
+  std::vector<uint16_t> shared;
+  std::vector<uint16_t> aliceOnly;
+  std::vector<uint16_t> bobOnly;
+  intersectHands(alice, bob, shared, aliceOnly, bobOnly);
+
+  // Back to cards for printing
+  auto toCards = [](const std::vector<uint16_t>& keys) {
+    std::vector<Card> cards;
+    cards.reserve(keys.size());
+    for (uint16_t key : keys) cards.push_back(FULL_DECK[packedCode(key)]);
+    return cards;
+  };
+  printOutcome(toCards(shared), toCards(aliceOnly), toCards(bobOnly), out);
+}
@@ -0,0 +1,42 @@
+// game.h
+// Author: Yusen Liu
+// The card matching game played on two CardList (or SuitedCardList) hands
+
+#ifndef GAME_H
+#define GAME_H
+
+#include <iostream>
+#include "card_list.h"
+#include "suited_card_list.h"
+#include "generator.h"
+#include <cstdint>
+#include <vector>
+
+enum Player { ALICE, BOB };
+
+struct Pick {
+    Player player;
+    Card card;
+};
+
+// The game as a lazy sequence of picks: Alice scans her hand from smallest to
+// largest for a card Bob also holds, then Bob scans his from largest to smallest,
+// until a round has no match. Each pick is yielded after the card has left both
+// hands, so stopping after k picks leaves the hands exactly k picks in. The
+// hands must outlive the generator.
+Generator<Pick> play(CardList& alice, CardList& bob);
+
+// Play the game to the end, printing every pick and then both remaining hands.
+// Empties the shared cards out of both hands. With picks, each pick is also
+// appended there (for a pick log, see pick_log.h).
+void playGame(CardList& alice, CardList& bob, std::ostream& out, std::vector<Pick>* picks = nullptr);
+
+// Same game on suit-partitioned hands: each turn is a search of the suits both
+// players hold instead of a scan with one contains() per card
+void playGame(SuitedCardList& alice, SuitedCardList& bob, std::ostream& out);
+
+// playFast on hands packed by packHand (intersect.h): the intersection and both
+// leftover hands come out of one vectorized pass over the key arrays
+void playFastPacked(const std::vector<uint16_t>& alice, const std::vector<uint16_t>& bob, std::ostream& out);
+
+#endif
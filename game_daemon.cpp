@@ -0,0 +1,530 @@
+// game_daemon.cpp
+// Author: Yusen Liu
+// Implementation of the classes and functions declared in game_daemon.h
+
+#include "game_daemon.h"
+#include "card_list.h"
+#include "game.h"
+#include "game_outcome.h"
+#include "stream_game.h"
+#include "trace.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <sstream>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Frame header sizes after the length field
+static const size_t REQUEST_HEADER = 6;     // id, kind, flags
+static const size_t RESPONSE_HEADER = 5;    // id, status
+static const int ACCEPT_POLL_MS = 100;
+
+// ====== Helper Functions ======
+
+static void putLittle(uint8_t* out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out[i] = uint8_t(value >> (8 * i));
+    }
+}
+
+static uint64_t getLittle(const uint8_t* in, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value |= uint64_t(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+static uint64_t nowMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// send() rather than write() so a client that went away is an error, not SIGPIPE
+static bool writeAll(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t sent = send(fd, data, length, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return false;
+        data += sent;
+        length -= size_t(sent);
+    }
+    return true;
+}
+
+static bool readAll(int fd, char* data, size_t length) {
+    while (length > 0) {
+        ssize_t got = read(fd, data, length);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) return false;
+        data += got;
+        length -= size_t(got);
+    }
+    return true;
+}
+
+static void appendResponse(std::string& out, uint32_t id, uint8_t status, const std::string& text) {
+    uint8_t header[4 + RESPONSE_HEADER];
+    putLittle(header, RESPONSE_HEADER + text.size(), 4);
+    putLittle(header + 4, id, 4);
+    header[8] = status;
+    out.append((const char*)header, sizeof(header));
+    out += text;
+}
+
+static sockaddr_un socketAddress(const std::string& path) {
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    memcpy(address.sun_path, path.data(), std::min(path.size(), sizeof(address.sun_path) - 1));
+    return address;
+}
+
+// Build a hand from cards in any order, reusing the nodes the hand already has
+static void fillHand(CardList& hand, std::vector<Card>& cards) {
+    std::sort(cards.begin(), cards.end());
+    hand.assignSorted(cards.data(), cards.size());
+}
+
+// Decode a 'B' payload into two card lists. False if the counts don't match
+// the payload or a code is not a card.
+static bool decodeBinaryHands(const std::string& payload, std::vector<Card>& alice, std::vector<Card>& bob) {
+    if (payload.size() < 8) return false;
+    const uint8_t* data = (const uint8_t*)payload.data();
+    uint64_t aliceCount = getLittle(data, 4);
+    uint64_t bobCount = getLittle(data + 4, 4);
+    if (payload.size() - 8 != aliceCount + bobCount) return false;
+    alice.clear();
+    bob.clear();
+    for (uint64_t i = 0; i < aliceCount + bobCount; i++) {
+        uint8_t code = data[8 + i];
+        if (code >= 52) return false;
+        (i < aliceCount ? alice : bob).push_back(Card::fromCode(code));
+    }
+    return true;
+}
+
+std::string formatMetrics(const DaemonMetrics& metrics) {
+    std::ostringstream out;
+    out << "requests " << metrics.requests << "\n"
+        << "errors " << metrics.errors << "\n"
+        << "batches " << metrics.batches << "\n"
+        << "connections " << metrics.connections << "\n"
+        << "latency_p50_us " << metrics.p50Micros << "\n"
+        << "latency_p99_us " << metrics.p99Micros << "\n"
+        << "latency_mean_us " << metrics.meanMicros << "\n";
+    return out.str();
+}
+
+// ====== Connection ======
+
+// One client. Shared by its reader and every queued job, so the socket stays
+// open until the last response for it has been written.
+struct GameDaemon::Connection {
+    int fd;
+    // Responses waiting to be sent. One worker at a time (the one that found
+    // writing false) sends, taking what others append until the outbox is
+    // empty, so a client that is slow to read holds at most one worker.
+    std::mutex outboxLock;
+    std::string outbox;
+    std::vector<uint64_t> outboxReceived;   // read time of each response in outbox
+    bool writing = false;
+
+    // Requests read but not yet answered. The reader waits on drained while
+    // inFlight is at DAEMON_MAX_IN_FLIGHT; closed wakes it for good.
+    std::mutex flowLock;
+    std::condition_variable drained;
+    size_t inFlight = 0;
+    bool closed = false;
+
+    explicit Connection(int socket) : fd(socket) {}
+    ~Connection() { ::close(fd); }
+
+    // Shut the socket down and release a reader waiting for room
+    void shut() {
+        shutdown(fd, SHUT_RDWR);
+        {
+            std::lock_guard<std::mutex> guard(flowLock);
+            closed = true;
+        }
+        drained.notify_all();
+    }
+
+    void answered(size_t count) {
+        {
+            std::lock_guard<std::mutex> guard(flowLock);
+            inFlight -= count;
+        }
+        drained.notify_all();
+    }
+};
+
+// ====== GameDaemon Methods ======
+
+GameDaemon::GameDaemon(const std::string& path, int threads, size_t maxBatch, int sendTimeoutMs)
+    : socketPath(path), threads(std::max(threads, 1)), maxBatch(std::max<size_t>(maxBatch, 1)),
+      sendTimeoutMs(std::max(sendTimeoutMs, 1)), listenFd(-1), stopping(false), requestCount(0), errorCount(0), batchCount(0), connectionCount(0) {}
+
+GameDaemon::~GameDaemon() {
+    stop();
+}
+
+bool GameDaemon::start(std::string& error) {
+    sockaddr_un address = socketAddress(socketPath);
+    if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) {
+        error = "Socket path must be 1 to " + std::to_string(sizeof(address.sun_path) - 1) + " characters";
+        return false;
+    }
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) {
+        error = "Could not create a socket";
+        return false;
+    }
+    unlink(socketPath.c_str());
+    if (bind(listenFd, (sockaddr*)&address, sizeof(address)) != 0 || listen(listenFd, SOMAXCONN) != 0) {
+        error = "Could not listen on " + socketPath;
+        ::close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+
+    stopping = false;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([this, t]() { workLoop(t); });
+    }
+    acceptor = std::thread([this]() { acceptLoop(); });
+    return true;
+}
+
+void GameDaemon::stop() {
+    if (listenFd < 0) return;
+    {
+        std::lock_guard<std::mutex> guard(queueLock);
+        stopping = true;
+    }
+    queueReady.notify_all();
+    acceptor.join();
+    ::close(listenFd);
+    listenFd = -1;
+    unlink(socketPath.c_str());
+
+    // Wake every reader out of read(), or out of waiting for room, by shutting
+    // its socket down
+    {
+        std::lock_guard<std::mutex> guard(connectionsLock);
+        for (auto& weak : connections) {
+            if (auto connection = weak.lock()) connection->shut();
+        }
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    readers.clear();
+    connections.clear();
+    workers.clear();
+    jobs.clear();
+}
+
+DaemonMetrics GameDaemon::metrics() const {
+    DaemonMetrics result;
+    result.requests = requestCount.load();
+    result.errors = errorCount.load();
+    result.batches = batchCount.load();
+    result.connections = connectionCount.load();
+    result.p50Micros = latency.percentile(0.50);
+    result.p99Micros = latency.percentile(0.99);
+    result.meanMicros = latency.mean();
+    return result;
+}
+
+void GameDaemon::acceptLoop() {
+    traceThreadName("daemon acceptor");
+    while (true) {
+        {
+            std::lock_guard<std::mutex> guard(queueLock);
+            if (stopping) return;
+        }
+        pollfd wait = {listenFd, POLLIN, 0};
+        if (poll(&wait, 1, ACCEPT_POLL_MS) <= 0) continue;
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) continue;
+
+        // A client that stops reading makes send() fail after the timeout
+        // rather than block a worker for good
+        timeval timeout = {sendTimeoutMs / 1000, (sendTimeoutMs % 1000) * 1000};
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        auto connection = std::make_shared<Connection>(fd);
+        connectionCount++;
+        std::lock_guard<std::mutex> guard(connectionsLock);
+        // Join the readers of connections that are gone: an expired connection's
+        // reader has already dropped its reference and is returning
+        for (size_t i = 0; i < connections.size();) {
+            if (connections[i].expired()) {
+                readers[i].join();
+                readers.erase(readers.begin() + i);
+                connections.erase(connections.begin() + i);
+            } else {
+                i++;
+            }
+        }
+        connections.push_back(connection);
+        readers.emplace_back([this, connection]() { readLoop(connection); });
+    }
+}
+
+void GameDaemon::readLoop(std::shared_ptr<Connection> connection) {
+    traceThreadName("daemon reader");
+    std::string buffer;
+    std::vector<char> chunk(64 << 10);
+    std::vector<Job> decoded;
+    uint64_t received = 0;
+    bool full = false;      // the buffer may hold frames there was no room for
+    while (true) {
+        size_t room;
+        {
+            std::unique_lock<std::mutex> guard(connection->flowLock);
+            connection->drained.wait(guard, [&]() {
+                return connection->closed || connection->inFlight < DAEMON_MAX_IN_FLIGHT;
+            });
+            if (connection->closed) return;
+            room = DAEMON_MAX_IN_FLIGHT - connection->inFlight;
+        }
+
+        if (!full) {
+            ssize_t got = read(connection->fd, chunk.data(), chunk.size());
+            if (got < 0 && errno == EINTR) continue;
+            if (got <= 0) return;
+            buffer.append(chunk.data(), size_t(got));
+            received = nowMicros();
+        }
+
+        // Every whole frame in the buffer that fits under the in-flight cap goes
+        // to the queue under one lock, so a client that pipelines requests fills
+        // a batch in one step
+        size_t at = 0;
+        full = false;
+        while (buffer.size() - at >= 4) {
+            const uint8_t* frame = (const uint8_t*)buffer.data() + at;
+            uint64_t length = getLittle(frame, 4);
+            if (length < REQUEST_HEADER || length > DAEMON_MAX_FRAME) return;
+            if (buffer.size() - at - 4 < length) break;
+            if (decoded.size() == room) {
+                full = true;
+                break;
+            }
+            Job job;
+            job.connection = connection;
+            job.id = uint32_t(getLittle(frame + 4, 4));
+            job.kind = frame[8];
+            job.flags = frame[9];
+            job.payload.assign((const char*)frame + 4 + REQUEST_HEADER, length - REQUEST_HEADER);
+            job.received = received;
+            decoded.push_back(std::move(job));
+            at += 4 + length;
+        }
+        buffer.erase(0, at);
+
+        if (!decoded.empty()) {
+            {
+                std::lock_guard<std::mutex> guard(connection->flowLock);
+                connection->inFlight += decoded.size();
+            }
+            {
+                std::lock_guard<std::mutex> guard(queueLock);
+                for (Job& job : decoded) {
+                    jobs.push_back(std::move(job));
+                }
+            }
+            queueReady.notify_all();
+            decoded.clear();
+        }
+    }
+}
+
+bool GameDaemon::popBatch(std::vector<Job>& batch) {
+    std::unique_lock<std::mutex> guard(queueLock);
+    queueReady.wait(guard, [this]() { return stopping || !jobs.empty(); });
+    if (stopping) return false;
+    // One connection per batch, so a client that is slow to read never holds
+    // up another's responses. Its pipelined requests sit together in the queue.
+    batch.clear();
+    std::shared_ptr<Connection> connection = jobs.front().connection;
+    while (!jobs.empty() && batch.size() < maxBatch && jobs.front().connection == connection) {
+        batch.push_back(std::move(jobs.front()));
+        jobs.pop_front();
+    }
+    return true;
+}
+
+void GameDaemon::workLoop(int index) {
+    traceThreadName("daemon worker " + std::to_string(index));
+
+    // Kept for the worker's life: after the first few games the hands build
+    // from their own spare nodes and the card vectors from their capacity
+    CardList alice;
+    CardList bob;
+    std::vector<Card> aliceCards;
+    std::vector<Card> bobCards;
+
+    // A batch's responses, all for one connection
+    std::string frames;
+    std::vector<Job> batch;
+
+    while (popBatch(batch)) {
+        TRACE_SCOPE("daemon batch");
+        batchCount++;
+        Connection& connection = *batch.front().connection;
+        bool closed;
+        {
+            std::lock_guard<std::mutex> guard(connection.flowLock);
+            closed = connection.closed;
+        }
+        if (closed) {
+            // Dropped or stopping: nobody will read these
+            connection.answered(batch.size());
+            batch.clear();
+            continue;
+        }
+
+        for (Job& job : batch) {
+            std::string text;
+            uint8_t status = DAEMON_OK;
+            bool hands = false;
+            if (job.kind == DAEMON_METRICS) {
+                text = formatMetrics(metrics());
+            } else if (job.kind == DAEMON_TEXT) {
+                std::istringstream in(job.payload);
+                GameRecord record;
+                hands = readGameRecord(in, record) && record.errors.empty();
+                if (hands) {
+                    aliceCards.assign(record.alice.begin(), record.alice.end());
+                    bobCards.assign(record.bob.begin(), record.bob.end());
+                } else if (!record.errors.empty()) {
+                    // Bad cards reject the request, one error per line
+                    for (const CardReadError& error : record.errors) {
+                        text += formatCardError(error) + "\n";
+                    }
+                } else {
+                    text = "Request has no hands";
+                }
+            } else if (job.kind == DAEMON_BINARY) {
+                hands = decodeBinaryHands(job.payload, aliceCards, bobCards);
+                if (!hands) text = "Binary hands are malformed";
+            } else {
+                text = "Unknown request kind";
+            }
+
+            if (hands) {
+                fillHand(alice, aliceCards);
+                fillHand(bob, bobCards);
+                std::ostringstream out;
+                if (job.flags & DAEMON_FAST) {
+                    playFast(alice, bob, out);
+                } else {
+                    playGame(alice, bob, out);
+                }
+                text = out.str();
+                alice.clear();
+                bob.clear();
+            } else if (job.kind != DAEMON_METRICS) {
+                status = DAEMON_ERROR;
+                errorCount++;
+            }
+            requestCount++;
+
+            appendResponse(frames, job.id, status, text);
+        }
+
+        {
+            std::lock_guard<std::mutex> guard(connection.outboxLock);
+            connection.outbox += frames;
+            for (const Job& job : batch) {
+                connection.outboxReceived.push_back(job.received);
+            }
+            bool sender = !connection.writing;
+            connection.writing = true;
+            if (!sender) {
+                // The worker already sending to this client will send these too
+                frames.clear();
+                batch.clear();
+                continue;
+            }
+        }
+        std::vector<uint64_t> received;
+        while (true) {
+            {
+                std::lock_guard<std::mutex> guard(connection.outboxLock);
+                if (connection.outbox.empty()) {
+                    connection.writing = false;
+                    break;
+                }
+                frames.swap(connection.outbox);
+                received.swap(connection.outboxReceived);
+                connection.outbox.clear();
+                connection.outboxReceived.clear();
+            }
+            // A client that went away or stopped reading is dropped; the rest of
+            // its responses then fail at once and its queued batches are skipped
+            if (!writeAll(connection.fd, frames.data(), frames.size())) connection.shut();
+            connection.answered(received.size());
+            uint64_t sent = nowMicros();
+            for (uint64_t time : received) {
+                latency.record(sent - time);
+            }
+        }
+        frames.clear();
+        batch.clear();
+    }
+}
+
+// ====== Client Side ======
+
+int connectDaemon(const std::string& path) {
+    sockaddr_un address = socketAddress(path);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (sockaddr*)&address, sizeof(address)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool sendRequest(int fd, uint32_t id, uint8_t kind, uint8_t flags, const std::string& payload) {
+    std::string frame(4 + REQUEST_HEADER, '\0');
+    uint8_t* header = (uint8_t*)frame.data();
+    putLittle(header, REQUEST_HEADER + payload.size(), 4);
+    putLittle(header + 4, id, 4);
+    header[8] = kind;
+    header[9] = flags;
+    frame += payload;
+    return writeAll(fd, frame.data(), frame.size());
+}
+
+bool readResponse(int fd, uint32_t& id, uint8_t& status, std::string& text) {
+    uint8_t header[4 + RESPONSE_HEADER];
+    if (!readAll(fd, (char*)header, sizeof(header))) return false;
+    uint64_t length = getLittle(header, 4);
+    if (length < RESPONSE_HEADER || length > DAEMON_MAX_FRAME) return false;
+    id = uint32_t(getLittle(header + 4, 4));
+    status = header[8];
+    text.resize(length - RESPONSE_HEADER);
+    return readAll(fd, text.data(), text.size());
+}
+
+std::string binaryHandsPayload(const std::vector<uint8_t>& alice, const std::vector<uint8_t>& bob) {
+    std::string payload(8, '\0');
+    putLittle((uint8_t*)payload.data(), alice.size(), 4);
+    putLittle((uint8_t*)payload.data() + 4, bob.size(), 4);
+    payload.append((const char*)alice.data(), alice.size());
+    payload.append((const char*)bob.data(), bob.size());
+    return payload;
+}
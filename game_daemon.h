@@ -0,0 +1,140 @@
+// game_daemon.h
+// Author: Yusen Liu
+// Long-running game server on a Unix domain socket, so many games can be played
+// without starting a process for each one.
+//
+// Every message is a frame, little-endian, on a stream socket:
+//   request:  uint32 length, uint32 id, uint8 kind, uint8 flags, payload
+//   response: uint32 length, uint32 id, uint8 status, text
+// length counts the bytes after itself. Request kinds:
+//   'T'  payload is one stream record: Alice's cards, a "--" line, Bob's cards
+//   'B'  payload is uint32 aliceCount, uint32 bobCount, then one code byte per card
+//   'M'  no payload; the response text is the daemon's metrics
+// flags bit 0 (DAEMON_FAST) plays with playFast instead of turn by turn. The
+// response text is exactly what game prints for the same hands; status 1 means
+// the text is an error message instead (for a 'T' request with bad cards, one
+// "Alice's hand:line: ..." line per card).
+//
+// A client may send many requests without waiting. Responses come back as games
+// finish, not necessarily in request order, so clients match them by id. The
+// daemon holds at most DAEMON_MAX_IN_FLIGHT of one connection's requests at a
+// time and stops reading from it until some are answered, so a client that never
+// reads its responses can't fill the daemon's memory. A response that can't be
+// sent within the send timeout closes the connection instead of holding a worker.
+//
+// Inside, one reader thread per connection decodes frames into a shared job
+// queue. A fixed pool of workers takes up to maxBatch jobs of one connection at
+// a time, plays them on hands kept for the worker's lifetime (cleared between
+// games, so their nodes are reused instead of allocated), and writes the batch's
+// responses in a single write, or leaves them to the worker already sending to
+// that client. A client that stops reading holds at most one worker, and once a
+// send to it times out its remaining requests are dropped unplayed.
+
+#ifndef GAME_DAEMON_H
+#define GAME_DAEMON_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "latency_histogram.h"
+
+const uint8_t DAEMON_TEXT = 'T';
+const uint8_t DAEMON_BINARY = 'B';
+const uint8_t DAEMON_METRICS = 'M';
+const uint8_t DAEMON_FAST = 1;
+const uint8_t DAEMON_OK = 0;
+const uint8_t DAEMON_ERROR = 1;
+const uint32_t DAEMON_MAX_FRAME = 64 << 20;     // larger frames close the connection
+const size_t DAEMON_MAX_IN_FLIGHT = 256;        // queued or playing requests per connection
+const int DAEMON_SEND_TIMEOUT_MS = 5000;
+
+// Counters reported by a metrics request and by game --daemon on exit
+struct DaemonMetrics {
+    uint64_t requests = 0;
+    uint64_t errors = 0;
+    uint64_t batches = 0;
+    uint64_t connections = 0;
+    uint64_t p50Micros = 0;     // request read to response written
+    uint64_t p99Micros = 0;
+    uint64_t meanMicros = 0;
+};
+
+std::string formatMetrics(const DaemonMetrics& metrics);
+
+class GameDaemon {
+private:
+    struct Connection;
+
+    struct Job {
+        std::shared_ptr<Connection> connection;
+        uint32_t id;
+        uint8_t kind;
+        uint8_t flags;
+        std::string payload;
+        uint64_t received;      // steady clock, microseconds
+    };
+
+    std::string socketPath;
+    int threads;
+    size_t maxBatch;
+    int sendTimeoutMs;
+    int listenFd;
+
+    std::mutex queueLock;
+    std::condition_variable queueReady;
+    std::deque<Job> jobs;
+    bool stopping;
+
+    std::mutex connectionsLock;
+    std::vector<std::weak_ptr<Connection>> connections;
+    std::vector<std::thread> readers;
+
+    std::thread acceptor;
+    std::vector<std::thread> workers;
+
+    LatencyHistogram latency;
+    std::atomic<uint64_t> requestCount;
+    std::atomic<uint64_t> errorCount;
+    std::atomic<uint64_t> batchCount;
+    std::atomic<uint64_t> connectionCount;
+
+    void acceptLoop();
+    void readLoop(std::shared_ptr<Connection> connection);
+    void workLoop(int index);
+    bool popBatch(std::vector<Job>& batch);
+
+public:
+    GameDaemon(const std::string& path, int threads, size_t maxBatch, int sendTimeoutMs = DAEMON_SEND_TIMEOUT_MS);
+    ~GameDaemon();
+    GameDaemon(const GameDaemon&) = delete;
+    GameDaemon& operator=(const GameDaemon&) = delete;
+
+    // Bind the socket (replacing a stale socket file) and start the threads.
+    // False with a message in error if the socket can't be set up.
+    bool start(std::string& error);
+
+    // Stop accepting, close every connection, finish and join all threads, and
+    // remove the socket file. Jobs still queued are dropped.
+    void stop();
+
+    DaemonMetrics metrics() const;
+};
+
+// ====== Client Side ======
+
+// Blocking helpers for clients (gameload and the tests). connectDaemon returns
+// an fd or -1. readResponse returns false on a closed connection or bad frame.
+int connectDaemon(const std::string& path);
+bool sendRequest(int fd, uint32_t id, uint8_t kind, uint8_t flags, const std::string& payload);
+bool readResponse(int fd, uint32_t& id, uint8_t& status, std::string& text);
+
+// Payload of a 'B' request for two hands of card codes
+std::string binaryHandsPayload(const std::vector<uint8_t>& alice, const std::vector<uint8_t>& bob);
+
+#endif
@@ -0,0 +1,84 @@
+// game_outcome.h
+// Author: Yusen Liu
+// Closed-form outcome of the card matching game, shared by game (CardList) and
+// game_set (std::set). Works on any hand type with sorted begin()/end() iteration.
+//
+// Each round Alice takes the smallest card both players hold and Bob the largest,
+// so the picks simply alternate inwards from the two ends of the ordered
+// intersection, and both final hands are the original hands minus that intersection.
+// One merge pass over the two sorted hands gives all three.
+
+#ifndef GAME_OUTCOME_H
+#define GAME_OUTCOME_H
+
+#include <iostream>
+#include <vector>
+#include "card.h"
+#include "trace.h"
+
+// Print both hands in the format the game ends with
+template <class AliceHand, class BobHand>
+void printHands(const AliceHand& alice, const BobHand& bob, std::ostream& out) {
+  TRACE_SCOPE("print hands");
+  out << std::endl;
+  out << "Alice's cards:" << std::endl;
+  for (auto it = alice.begin(); it != alice.end(); ++it) {
+    out << *it << std::endl;
+  }
+
+  out << std::endl;
+  out << "Bob's cards:" << std::endl;
+  for (auto it = bob.begin(); it != bob.end(); ++it) {
+    out << *it << std::endl;
+  }
+}
+
+// Print the game's output given the ordered intersection and what is left of
+// each hand: Alice takes from the low end of the intersection, Bob from the
+// high end, until they meet
+inline void printOutcome(const std::vector<Card>& shared, const std::vector<Card>& aliceLeft,
+                         const std::vector<Card>& bobLeft, std::ostream& out) {
+  size_t low = 0;
+  size_t high = shared.size();
+  while (low < high) {
+    out << "Alice picked matching card " << shared[low++] << std::endl;
+    if (low < high) {
+      out << "Bob picked matching card " << shared[--high] << std::endl;
+    }
+  }
+
+  printHands(aliceLeft, bobLeft, out);
+}
+
+// Produce exactly the output of the turn-by-turn game without simulating it.
+// The hands are only read.
+template <class Hand>
+void playFast(const Hand& alice, const Hand& bob, std::ostream& out) {
+  TRACE_SCOPE("fast outcome");
+  std::vector<Card> shared;
+  std::vector<Card> aliceLeft;
+  std::vector<Card> bobLeft;
+
+  // Linear merge of the two sorted hands
+  auto a = alice.begin();
+  auto b = bob.begin();
+  while (a != alice.end() && b != bob.end()) {
+    if (*a < *b) {
+      aliceLeft.push_back(*a);
+      ++a;
+    } else if (*b < *a) {
+      bobLeft.push_back(*b);
+      ++b;
+    } else {
+      shared.push_back(*a);
+      ++a;
+      ++b;
+    }
+  }
+  for (; a != alice.end(); ++a) aliceLeft.push_back(*a);
+  for (; b != bob.end(); ++b) bobLeft.push_back(*b);
+
+  printOutcome(shared, aliceLeft, bobLeft, out);
+}
+
+#endif
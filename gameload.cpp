@@ -0,0 +1,163 @@
+// gameload.cpp
+// Author: Yusen Liu
+// Load generator for game --daemon. Each client connects, keeps up to pipeline
+// requests in flight with random hands, and times every request from send to
+// response. Prints throughput and round-trip p50/p99, then the daemon's own
+// metrics.
+// Usage: ./gameload socket [--clients C] [--requests N] [--cards K]
+//                   [--pipeline P] [--binary] [--fast]
+
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "card.h"
+#include "game_daemon.h"
+#include "latency_histogram.h"
+
+using namespace std;
+
+struct LoadOptions {
+    string socket;
+    int clients = 4;
+    size_t requests = 10000;    // over all clients
+    size_t cards = 26;          // per hand, at most 52
+    size_t pipeline = 16;
+    bool binary = false;
+    bool fast = false;
+};
+
+static uint64_t nowMicros() {
+    return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// A request for two random hands of distinct cards
+static string randomRequest(const LoadOptions& options, mt19937& rng) {
+    vector<uint8_t> deck(52);
+    for (int code = 0; code < 52; code++) {
+        deck[code] = uint8_t(code);
+    }
+    vector<uint8_t> hands[2];
+    for (auto& hand : hands) {
+        shuffle(deck.begin(), deck.end(), rng);
+        hand.assign(deck.begin(), deck.begin() + options.cards);
+    }
+    if (options.binary) return binaryHandsPayload(hands[0], hands[1]);
+
+    ostringstream text;
+    for (uint8_t code : hands[0]) {
+        text << Card::fromCode(code) << "\n";
+    }
+    text << "--\n";
+    for (uint8_t code : hands[1]) {
+        text << Card::fromCode(code) << "\n";
+    }
+    return text.str();
+}
+
+// One client's share of the requests. False if the connection failed.
+static bool runClient(const LoadOptions& options, int index, size_t count, LatencyHistogram& latency,
+                      atomic<size_t>& errors) {
+    int fd = connectDaemon(options.socket);
+    if (fd < 0) return false;
+    mt19937 rng(index + 1);
+    uint8_t kind = options.binary ? DAEMON_BINARY : DAEMON_TEXT;
+    uint8_t flags = options.fast ? DAEMON_FAST : 0;
+
+    // Send times by id; ids are request numbers within this client
+    vector<uint64_t> sentAt(count);
+    size_t sent = 0;
+    size_t received = 0;
+    bool ok = true;
+    while (ok && received < count) {
+        while (sent < count && sent - received < options.pipeline) {
+            string payload = randomRequest(options, rng);
+            sentAt[sent] = nowMicros();
+            if (!sendRequest(fd, uint32_t(sent), kind, flags, payload)) {
+                ok = false;
+                break;
+            }
+            sent++;
+        }
+        uint32_t id;
+        uint8_t status;
+        string text;
+        if (!ok || !readResponse(fd, id, status, text) || id >= count) {
+            ok = false;
+            break;
+        }
+        latency.record(nowMicros() - sentAt[id]);
+        if (status != DAEMON_OK) errors++;
+        received++;
+    }
+    close(fd);
+    return ok;
+}
+
+int main(int argv, char** argc) {
+    LoadOptions options;
+    for (int i = 1; i < argv; i++) {
+        string arg = argc[i];
+        if (arg == "--clients" && i + 1 < argv) {
+            options.clients = max(1, stoi(argc[++i]));
+        } else if (arg == "--requests" && i + 1 < argv) {
+            options.requests = stoul(argc[++i]);
+        } else if (arg == "--cards" && i + 1 < argv) {
+            options.cards = min<size_t>(52, stoul(argc[++i]));
+        } else if (arg == "--pipeline" && i + 1 < argv) {
+            options.pipeline = max<size_t>(1, stoul(argc[++i]));
+        } else if (arg == "--binary") {
+            options.binary = true;
+        } else if (arg == "--fast") {
+            options.fast = true;
+        } else {
+            options.socket = arg;
+        }
+    }
+    if (options.socket.empty()) {
+        cout << "Usage: gameload socket [--clients C] [--requests N] [--cards K]" << endl;
+        cout << "                [--pipeline P] [--binary] [--fast]" << endl;
+        return 1;
+    }
+
+    LatencyHistogram latency;
+    atomic<size_t> errors(0);
+    atomic<int> failedClients(0);
+    vector<thread> clients;
+    auto start = chrono::steady_clock::now();
+    for (int c = 0; c < options.clients; c++) {
+        size_t count = options.requests / options.clients + (size_t(c) < options.requests % options.clients ? 1 : 0);
+        clients.emplace_back([&, c, count]() {
+            if (!runClient(options, c, count, latency, errors)) failedClients++;
+        });
+    }
+    for (auto& client : clients) {
+        client.join();
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    if (failedClients > 0) {
+        cout << failedClients << " clients lost their connection to " << options.socket << endl;
+    }
+    cout << "requests:    " << latency.count() << " (" << errors << " errors)" << endl;
+    cout << "throughput:  " << uint64_t(latency.count() / seconds) << " games/s" << endl;
+    cout << "round trip:  p50 " << latency.percentile(0.50) << " us, p99 " << latency.percentile(0.99)
+         << " us, mean " << latency.mean() << " us" << endl;
+
+    // The daemon's view: time from reading a request to writing its response
+    int fd = connectDaemon(options.socket);
+    uint32_t id;
+    uint8_t status;
+    string text;
+    if (fd >= 0 && sendRequest(fd, 0, DAEMON_METRICS, 0, "") && readResponse(fd, id, status, text)) {
+        cout << "daemon:" << endl << text;
+    }
+    if (fd >= 0) close(fd);
+    return failedClients > 0 ? 1 : 0;
+}
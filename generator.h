@@ -0,0 +1,100 @@
+// generator.h
+// Author: Yusen Liu
+// Minimal C++20 coroutine generator, in the spirit of C++23's std::generator.
+// A function returning Generator<T> runs lazily: nothing happens until the
+// first value is asked for, and it stops at every co_yield until the next one
+// is. Dropping the generator destroys the suspended coroutine.
+//
+// Values can be pulled with a range-for, or one at a time with next()/value(),
+// which is what a scheduler interleaving many generators on one thread uses.
+
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include <coroutine>
+#include <exception>
+#include <iterator>
+#include <utility>
+
+template <class T>
+class Generator {
+public:
+    struct promise_type {
+        const T* current = nullptr;     // the yielded value lives in the suspended frame
+        std::exception_ptr error;
+
+        Generator get_return_object() {
+            return Generator(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        std::suspend_always yield_value(const T& value) noexcept {
+            current = &value;
+            return {};
+        }
+        void return_void() {}
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+
+private:
+    std::coroutine_handle<promise_type> handle;
+
+    explicit Generator(std::coroutine_handle<promise_type> h) : handle(h) {}
+
+public:
+    class Iterator {
+    private:
+        Generator* gen;     // nullptr at end
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+
+        Iterator(Generator* g = nullptr) : gen(g) {}
+
+        Iterator& operator++() {
+            if (!gen->next()) gen = nullptr;
+            return *this;
+        }
+        void operator++(int) { ++*this; }
+
+        const T& operator*() const { return gen->value(); }
+        const T* operator->() const { return &gen->value(); }
+
+        bool operator==(const Iterator& other) const { return gen == other.gen; }
+        bool operator!=(const Iterator& other) const { return gen != other.gen; }
+    };
+
+    Generator(const Generator&) = delete;
+    Generator& operator=(const Generator&) = delete;
+    Generator(Generator&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+    Generator& operator=(Generator&& other) noexcept {
+        if (this != &other) {
+            if (handle) handle.destroy();
+            handle = std::exchange(other.handle, nullptr);
+        }
+        return *this;
+    }
+    ~Generator() {
+        if (handle) handle.destroy();
+    }
+
+    // Run to the next co_yield. Returns false once the coroutine has finished;
+    // an exception thrown inside it is rethrown here.
+    bool next() {
+        if (!handle || handle.done()) return false;
+        handle.resume();
+        if (handle.promise().error) std::rethrow_exception(std::exchange(handle.promise().error, nullptr));
+        return !handle.done();
+    }
+
+    // The value from the last successful next()
+    const T& value() const { return *handle.promise().current; }
+
+    // Iterator support (single pass: begin() starts the coroutine)
+    Iterator begin() { return next() ? Iterator(this) : Iterator(); }
+    Iterator end() { return Iterator(); }
+};
+
+#endif
@@ -0,0 +1,323 @@
+// hand_file.cpp
+// Author: Yusen Liu
+// Implementation of the functions declared in hand_file.h
+
+#include "hand_file.h"
+#include "hand_parser.h"
+#include "trace.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+// ====== Helper Functions ======
+
+static void putLittle(uint8_t* out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out[i] = uint8_t(value >> (8 * i));
+    }
+}
+
+static uint64_t getLittle(const uint8_t* in, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value |= uint64_t(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+// ====== Reading ======
+
+bool isBinaryHandFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    char magic[4];
+    return file.read(magic, 4) && memcmp(magic, "HAND", 4) == 0;
+}
+
+bool readBinaryHand(const std::string& path, std::vector<uint8_t>& codes, bool& sorted) {
+    std::ifstream file(path, std::ios::binary);
+    uint8_t header[HAND_HEADER_SIZE];
+    if (!file.read((char*)header, HAND_HEADER_SIZE)) return false;
+    if (memcmp(header, "HAND", 4) != 0 || header[4] != HAND_VERSION) return false;
+
+    uint8_t flags = header[5];
+    size_t decks = getLittle(header + 6, 2);
+    size_t count = getLittle(header + 8, 4);
+
+    // Check the header against the file before allocating anything it asks for
+    file.seekg(0, std::ios::end);
+    size_t payload = size_t(file.tellg()) - HAND_HEADER_SIZE;
+    file.seekg(HAND_HEADER_SIZE);
+    if (flags & HAND_MASKS ? decks * 8 > payload || count > decks * 52 : count > payload) return false;
+
+    if (flags & HAND_MASKS) {
+        // Expand per-deck masks back into ascending codes
+        std::vector<uint8_t> raw(decks * 8);
+        if (!file.read((char*)raw.data(), raw.size())) return false;
+        uint32_t copies[52] = {0};     // up to 65535 decks
+        for (size_t d = 0; d < decks; d++) {
+            uint64_t mask = getLittle(raw.data() + 8 * d, 8);
+            if (mask >> 52) return false;
+            for (int code = 0; code < 52; code++) {
+                copies[code] += (mask >> code) & 1;
+            }
+        }
+        codes.clear();
+        codes.reserve(count);
+        for (int code = 0; code < 52; code++) {
+            codes.insert(codes.end(), copies[code], uint8_t(code));
+        }
+        sorted = true;
+        return codes.size() == count;
+    }
+
+    // One byte per card: a single read straight into the output
+    codes.resize(count);
+    if (!file.read((char*)codes.data(), count)) return false;
+    for (uint8_t code : codes) {
+        if (code >= 52) return false;
+    }
+    // Trust but verify: a wrong sorted flag must not corrupt a bulk-built tree
+    sorted = (flags & HAND_SORTED) && std::is_sorted(codes.begin(), codes.end());
+    return true;
+}
+
+bool readHand(const std::string& path, std::vector<uint8_t>& codes, bool& sorted) {
+    if (isBinaryHandFile(path)) return readBinaryHand(path, codes, sorted);
+    if (!readHandFile(path, codes)) return false;
+    sorted = std::is_sorted(codes.begin(), codes.end());
+    return true;
+}
+
+bool readHandCards(const std::string& path, std::vector<Card>& cards, bool& sorted) {
+    TRACE_SCOPE("read hand file");
+    std::vector<uint8_t> codes;
+    if (!readHand(path, codes, sorted)) return false;
+    cards.clear();
+    cards.reserve(codes.size());
+    for (uint8_t code : codes) {
+        cards.push_back(Card::fromCode(code));
+    }
+    return true;
+}
+
+bool parseBadCardPolicy(const std::string& text, BadCardPolicy& policy) {
+    if (text == "reject") {
+        policy = REJECT_BAD_CARDS;
+    } else if (text == "skip") {
+        policy = SKIP_BAD_CARDS;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::string formatCardError(const CardReadError& error) {
+    return error.file + ":" + std::to_string(error.line) + ": " + cardParseErrorMessage(error.error)
+        + " '" + error.token + "'";
+}
+
+bool readTextCards(std::istream& in, const std::string& name, BadCardPolicy policy,
+                   std::vector<Card>& cards, std::vector<CardReadError>& errors) {
+    std::string line;
+    std::string suit;           // a suit waiting for its value, possibly on a later line
+    size_t suitLine = 0;
+    size_t lineNumber = 0;
+
+    auto bad = [&](size_t at, CardParseError error, const std::string& token) {
+        errors.push_back(CardReadError{name, at, error, token});
+        return policy == SKIP_BAD_CARDS;
+    };
+
+    while (std::getline(in, line)) {
+        lineNumber++;
+        size_t pos = 0;
+        while (true) {
+            size_t start = line.find_first_not_of(" \t\r", pos);
+            if (start == std::string::npos) break;
+            size_t end = line.find_first_of(" \t\r", start);
+            if (end == std::string::npos) end = line.size();
+            std::string_view token(line.data() + start, end - start);
+            pos = end;
+
+            // A suit on its own, or a suit with the value attached ("h10")
+            std::string_view value = token;
+            std::string text(token);
+            if (suit.empty()) {
+                if (Card::suitRank(token[0]) < 0) {
+                    if (!bad(lineNumber, CARD_BAD_SUIT, text)) return false;
+                    break;
+                }
+                suit = token[0];
+                suitLine = lineNumber;
+                if (token.size() == 1) continue;
+                value = token.substr(1);
+            } else {
+                text = suit + " " + text;
+            }
+
+            Card card;
+            CardParseError error = Card::parse(suit, value, card);
+            suit.clear();
+            if (error == CARD_OK) {
+                cards.push_back(card);
+                continue;
+            }
+            if (!bad(suitLine, error, text)) return false;
+            break;      // the rest of a bad line is dropped
+        }
+    }
+
+    if (!suit.empty()) {
+        Card card;
+        CardParseError error = Card::parse(suit, "", card);
+        if (!bad(suitLine, error, suit)) return false;
+    }
+    return in.eof();
+}
+
+// Parse one newline-aligned chunk and count each card
+static bool tallyChunk(const char* data, size_t length, size_t counts[52]) {
+    std::vector<uint8_t> codes(maxCardsInText(length));
+    HandParseResult result = parseHandText(data, length, codes.data(), codes.size());
+    for (size_t i = 0; i < result.cards; i++) {
+        counts[codes[i]]++;
+    }
+    return result.ok;
+}
+
+bool readHandCardsParallel(const std::string& path, std::vector<Card>& cards, bool& sorted,
+                           int threads, size_t minChunkBytes) {
+    if (isBinaryHandFile(path)) return readHandCards(path, cards, sorted);
+
+    std::vector<char> text;
+    {
+        TRACE_SCOPE("read file");
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (file.fail()) return false;
+        text.resize(size_t(file.tellg()));
+        file.seekg(0);
+        file.read(text.data(), text.size());
+    }
+
+    size_t chunks = std::min<size_t>(std::max(threads, 1), text.size() / std::max<size_t>(minChunkBytes, 1));
+    if (chunks <= 1) return readHandCards(path, cards, sorted);
+
+    // Cut at newlines so no card is split between chunks
+    std::vector<size_t> bounds(1, 0);
+    for (size_t i = 1; i < chunks; i++) {
+        size_t cut = std::max(bounds.back(), text.size() * i / chunks);
+        while (cut < text.size() && text[cut] != '\n') cut++;
+        bounds.push_back(cut);
+    }
+    bounds.push_back(text.size());
+
+    std::vector<std::array<size_t, 52>> counts(chunks);
+    std::vector<char> ok(chunks, 0);
+    std::vector<std::thread> workers;
+    for (size_t c = 0; c < chunks; c++) {
+        workers.emplace_back([&, c]() {
+            traceThreadName("parse chunk " + std::to_string(c));
+            TRACE_SCOPE("parse chunk");
+            counts[c].fill(0);
+            ok[c] = tallyChunk(text.data() + bounds[c], bounds[c + 1] - bounds[c], counts[c].data());
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+
+    // A card split across lines can't be parsed in pieces; parse the whole file instead
+    for (char chunkOk : ok) {
+        if (!chunkOk) return readHandCards(path, cards, sorted);
+    }
+
+    // Merge the per-chunk runs: total each card, then emit in code order
+    TRACE_SCOPE("merge chunks");
+    cards.clear();
+    for (int code = 0; code < 52; code++) {
+        size_t total = 0;
+        for (size_t c = 0; c < chunks; c++) {
+            total += counts[c][code];
+        }
+        cards.insert(cards.end(), total, Card::fromCode(code));
+    }
+    sorted = true;
+    return true;
+}
+
+bool loadHandCards(const std::string& path, BadCardPolicy policy, int threads,
+                   std::vector<Card>& cards, bool& sorted, std::ostream& report) {
+    if (readHandCardsParallel(path, cards, sorted, threads)) return true;
+
+    // Not something the bulk parser accepts: the validating reader finds the bad
+    // cards and where they are
+    TRACE_SCOPE("validating parse");
+    std::ifstream file(path);
+    std::vector<CardReadError> errors;
+    cards.clear();
+    sorted = false;
+    bool ok = readTextCards(file, path, policy, cards, errors);
+    const size_t shown = 10;
+    for (size_t i = 0; i < errors.size() && i < shown; i++) {
+        report << formatCardError(errors[i]) << (policy == SKIP_BAD_CARDS ? " (skipped)" : "") << std::endl;
+    }
+    if (errors.size() > shown) {
+        report << path << ": " << errors.size() - shown << " more bad cards" << std::endl;
+    }
+    return ok;
+}
+
+// ====== Writing ======
+
+bool writeBinaryHand(const std::string& path, std::vector<uint8_t> codes, bool useMasks) {
+    std::sort(codes.begin(), codes.end());
+
+    // Deck count is the largest number of copies of any one card
+    size_t decks = 0;
+    for (size_t i = 0; i < codes.size(); ) {
+        size_t j = i;
+        while (j < codes.size() && codes[j] == codes[i]) j++;
+        decks = std::max(decks, j - i);
+        i = j;
+    }
+
+    // The card count field is 32 bits and must be exact
+    if (codes.size() > 0xffffffff) return false;
+
+    // The deck count field is 16 bits: masks need it exact, plain codes don't
+    if (useMasks && decks > 0xffff) return false;
+    decks = std::min<size_t>(decks, 0xffff);
+
+    uint8_t header[HAND_HEADER_SIZE];
+    memcpy(header, "HAND", 4);
+    header[4] = HAND_VERSION;
+    header[5] = HAND_SORTED | (useMasks ? HAND_MASKS : 0);
+    putLittle(header + 6, decks, 2);
+    putLittle(header + 8, codes.size(), 4);
+
+    std::ofstream file(path, std::ios::binary);
+    file.write((const char*)header, HAND_HEADER_SIZE);
+    if (useMasks) {
+        std::vector<uint8_t> raw(decks * 8, 0);
+        uint32_t copies[52] = {0};
+        for (uint8_t code : codes) {
+            size_t deck = copies[code]++;
+            uint64_t mask = getLittle(raw.data() + 8 * deck, 8) | (uint64_t(1) << code);
+            putLittle(raw.data() + 8 * deck, mask, 8);
+        }
+        file.write((const char*)raw.data(), raw.size());
+    } else {
+        file.write((const char*)codes.data(), codes.size());
+    }
+    return bool(file);
+}
+
+bool writeTextHand(const std::string& path, const std::vector<uint8_t>& codes) {
+    std::ofstream file(path);
+    for (uint8_t code : codes) {
+        file << Card::fromCode(code) << '\n';
+    }
+    return bool(file);
+}
@@ -0,0 +1,87 @@
+// hand_file.h
+// Author: Yusen Liu
+// Reading and writing hand files in either the text format ("h 10" per line) or
+// the compact binary .hand format, with the format detected from the file itself.
+//
+// Binary .hand layout (little-endian, 12-byte header):
+//   0  char[4]  magic "HAND"
+//   4  uint8    version (1)
+//   5  uint8    flags: HAND_SORTED (codes ascending), HAND_MASKS (mask payload)
+//   6  uint16   deck count
+//   8  uint32   card count
+//   12 payload  card count one-byte codes (Card::toCode), or with HAND_MASKS one
+//               uint64 per deck where mask k holds every card with more than k copies
+
+#ifndef HAND_FILE_H
+#define HAND_FILE_H
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "card.h"
+
+const uint8_t HAND_VERSION = 1;
+const uint8_t HAND_SORTED = 1;
+const uint8_t HAND_MASKS = 2;
+const size_t HAND_HEADER_SIZE = 12;
+
+// True if the file starts with the binary magic
+bool isBinaryHandFile(const std::string& path);
+
+// Read a binary .hand file into codes. sorted is true when the codes are ascending.
+bool readBinaryHand(const std::string& path, std::vector<uint8_t>& codes, bool& sorted);
+
+// Read either format into codes; sorted is checked for text files
+bool readHand(const std::string& path, std::vector<uint8_t>& codes, bool& sorted);
+
+// Same, decoded into cards
+bool readHandCards(const std::string& path, std::vector<Card>& cards, bool& sorted);
+
+// What to do with a bad card in a text hand: fail the whole read, or drop the
+// rest of its line and keep going
+enum BadCardPolicy { REJECT_BAD_CARDS, SKIP_BAD_CARDS };
+
+// "reject" or "skip", as given to --on-error=. False for anything else.
+bool parseBadCardPolicy(const std::string& text, BadCardPolicy& policy);
+
+// A bad card found by readTextCards
+struct CardReadError {
+    std::string file;
+    size_t line;            // 1-based
+    CardParseError error;
+    std::string token;
+};
+
+// "file:line: message 'token'"
+std::string formatCardError(const CardReadError& error);
+
+// Validating reader for the text format, one token pair at a time with line
+// numbers (a card may also be written "h10", or split over two lines). Never
+// throws. Every bad card is appended to errors; returns false if the policy is
+// reject and there was one, or if the stream can't be read.
+bool readTextCards(std::istream& in, const std::string& name, BadCardPolicy policy,
+                   std::vector<Card>& cards, std::vector<CardReadError>& errors);
+
+// Read either format, splitting large text files into chunks of at least
+// minChunkBytes parsed by up to threads threads. Chunks are tallied per card and
+// merged into one ascending run, so the result is always sorted.
+bool readHandCardsParallel(const std::string& path, std::vector<Card>& cards, bool& sorted,
+                           int threads, size_t minChunkBytes = 1 << 20);
+
+// Load a hand the way game does: readHandCardsParallel, then readTextCards for a
+// file it refuses, reporting the first ten bad cards on report ("(skipped)" under
+// the skip policy). False if the file can't be read or a card is rejected.
+bool loadHandCards(const std::string& path, BadCardPolicy policy, int threads,
+                   std::vector<Card>& cards, bool& sorted, std::ostream& report);
+
+// Write codes as a binary .hand file. The codes are sorted first, so the file can
+// always be bulk-loaded; useMasks stores one 64-bit mask per deck instead, and
+// fails if a card has more than 65535 copies. Fails for more than 2^32 - 1 cards.
+bool writeBinaryHand(const std::string& path, std::vector<uint8_t> codes, bool useMasks);
+
+// Write codes in the text format, one card per line
+bool writeTextHand(const std::string& path, const std::vector<uint8_t>& codes);
+
+#endif
@@ -0,0 +1,247 @@
+// hand_parser.cpp
+// Author: Yusen Liu
+// Implementation of the functions declared in hand_parser.h
+
+#include "hand_parser.h"
+#include <cstring>
+#include <fstream>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAND_PARSER_X86 1
+#endif
+
+// ====== Lookup Tables ======
+
+// Suit rank (c=0, d=1, s=2, h=3) or -1, and single-character value rank or -1
+struct TokenTables {
+    int8_t suit[256];
+    int8_t value[256];
+
+    TokenTables() {
+        memset(suit, -1, sizeof(suit));
+        memset(value, -1, sizeof(value));
+        suit[(unsigned char)'c'] = 0;
+        suit[(unsigned char)'d'] = 1;
+        suit[(unsigned char)'s'] = 2;
+        suit[(unsigned char)'h'] = 3;
+        value[(unsigned char)'a'] = 1;
+        for (char v = '2'; v <= '9'; v++) {
+            value[(unsigned char)v] = v - '0';
+        }
+        value[(unsigned char)'j'] = 11;
+        value[(unsigned char)'q'] = 12;
+        value[(unsigned char)'k'] = 13;
+    }
+};
+
+static const TokenTables tables;
+
+// ====== Delimiter Scanners ======
+// Each returns a 32-bit mask with bit i set when block[i] is whitespace
+// (space, tab, newline or carriage return), the same set operator>> skips.
+
+static uint32_t whitespaceMaskScalar(const char* block) {
+    uint32_t mask = 0;
+    for (int i = 0; i < 32; i++) {
+        char ch = block[i];
+        if (ch == ' ' || ch == '\n' || ch == '\r' || ch == '\t') mask |= uint32_t(1) << i;
+    }
+    return mask;
+}
+
+#ifdef HAND_PARSER_X86
+static uint32_t whitespaceMaskSse2(const char* block) {
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i ret = _mm_set1_epi8('\r');
+    const __m128i tab = _mm_set1_epi8('\t');
+    uint32_t mask = 0;
+    for (int half = 0; half < 2; half++) {
+        __m128i bytes = _mm_loadu_si128((const __m128i*)(block + 16 * half));
+        __m128i ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, space), _mm_cmpeq_epi8(bytes, newline)),
+                                  _mm_or_si128(_mm_cmpeq_epi8(bytes, ret), _mm_cmpeq_epi8(bytes, tab)));
+        mask |= uint32_t(_mm_movemask_epi8(ws)) << (16 * half);
+    }
+    return mask;
+}
+
+__attribute__((target("avx2")))
+static uint32_t whitespaceMaskAvx2(const char* block) {
+    __m256i bytes = _mm256_loadu_si256((const __m256i*)block);
+    __m256i ws = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\n'))),
+        _mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\r')), _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\t'))));
+    return uint32_t(_mm256_movemask_epi8(ws));
+}
+#endif
+
+// ====== Tokenizer ======
+
+// Turns token boundaries into card codes. Tokens alternate suit, value.
+class CardTokenSink {
+private:
+    const char* data;
+    uint8_t* codes;
+    size_t capacity;
+    int pendingSuit;    // -1 when the next token is a suit
+    size_t suitOffset;
+
+public:
+    HandParseResult result;
+
+    CardTokenSink(const char* d, uint8_t* c, size_t cap)
+        : data(d), codes(c), capacity(cap), pendingSuit(-1), suitOffset(0), result{0, true, 0} {}
+
+    // Returns false to stop parsing
+    bool token(size_t start, size_t end) {
+        size_t length = end - start;
+        unsigned char first = (unsigned char)data[start];
+
+        if (pendingSuit < 0) {
+            int suit = tables.suit[first];
+            if (length != 1 || suit < 0) return fail(start);
+            pendingSuit = suit;
+            suitOffset = start;
+            return true;
+        }
+
+        int value;
+        if (length == 1) {
+            value = tables.value[first];
+        } else if (length == 2 && first == '1' && data[start + 1] == '0') {
+            value = 10;
+        } else {
+            value = -1;
+        }
+        if (value < 0) return fail(start);
+        if (result.cards == capacity) return fail(suitOffset);
+
+        codes[result.cards++] = uint8_t(pendingSuit * 13 + value - 1);
+        pendingSuit = -1;
+        return true;
+    }
+
+    bool fail(size_t offset) {
+        result.ok = false;
+        result.errorOffset = offset;
+        return false;
+    }
+
+    void finish() {
+        // A suit with no value after it
+        if (result.ok && pendingSuit >= 0) fail(suitOffset);
+    }
+};
+
+// Walk the buffer 32 bytes at a time. From each block's whitespace mask the bits
+// where a token starts or ends are found with a shift, then visited in order, so
+// the per-byte work is only for bytes that begin or finish a token.
+template <uint32_t (*WhitespaceMask)(const char*)>
+static HandParseResult tokenize(const char* data, size_t length, uint8_t* codes, size_t capacity) {
+    CardTokenSink sink(data, codes, capacity);
+    bool prevInToken = false;   // last byte of the previous block was inside a token
+    size_t tokenStart = 0;
+
+    for (size_t base = 0; base < length; base += 32) {
+        uint32_t ws;
+        if (length - base >= 32) {
+            ws = WhitespaceMask(data + base);
+        } else {
+            // Pad the tail with spaces so a trailing token still ends
+            char tail[32];
+            memset(tail, ' ', sizeof(tail));
+            memcpy(tail, data + base, length - base);
+            ws = WhitespaceMask(tail);
+        }
+
+        uint32_t inToken = ~ws;
+        uint32_t shifted = (inToken << 1) | (prevInToken ? 1u : 0u);
+        uint32_t starts = inToken & ~shifted;
+        uint32_t ends = ~inToken & shifted;
+        prevInToken = (inToken >> 31) & 1;
+
+        uint32_t events = starts | ends;
+        while (events != 0) {
+            int bit = __builtin_ctz(events);
+            events &= events - 1;
+            if (starts & (uint32_t(1) << bit)) {
+                tokenStart = base + bit;
+            } else if (!sink.token(tokenStart, base + bit)) {
+                return sink.result;
+            }
+        }
+    }
+
+    // Buffer ended exactly on a 32-byte boundary inside a token
+    if (prevInToken && !sink.token(tokenStart, length)) return sink.result;
+    sink.finish();
+    return sink.result;
+}
+
+// ====== Public Functions ======
+
+bool handParserKernelSupported(HandParserKernel kernel) {
+#ifdef HAND_PARSER_X86
+    __builtin_cpu_init();
+#endif
+    switch (kernel) {
+        case PARSER_SCALAR:
+            return true;
+#ifdef HAND_PARSER_X86
+        case PARSER_SSE2:
+            return __builtin_cpu_supports("sse2");
+        case PARSER_AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+HandParserKernel bestHandParserKernel() {
+    static const HandParserKernel best =
+        handParserKernelSupported(PARSER_AVX2) ? PARSER_AVX2 :
+        handParserKernelSupported(PARSER_SSE2) ? PARSER_SSE2 : PARSER_SCALAR;
+    return best;
+}
+
+const char* handParserKernelName(HandParserKernel kernel) {
+    switch (kernel) {
+        case PARSER_SSE2: return "sse2";
+        case PARSER_AVX2: return "avx2";
+        default: return "scalar";
+    }
+}
+
+size_t maxCardsInText(size_t length) {
+    // Smallest card is "s v" plus a delimiter
+    return length / 4 + 1;
+}
+
+HandParseResult parseHandTextWith(HandParserKernel kernel, const char* data, size_t length,
+                                  uint8_t* codes, size_t capacity) {
+#ifdef HAND_PARSER_X86
+    if (kernel == PARSER_AVX2) return tokenize<whitespaceMaskAvx2>(data, length, codes, capacity);
+    if (kernel == PARSER_SSE2) return tokenize<whitespaceMaskSse2>(data, length, codes, capacity);
+#endif
+    return tokenize<whitespaceMaskScalar>(data, length, codes, capacity);
+}
+
+HandParseResult parseHandText(const char* data, size_t length, uint8_t* codes, size_t capacity) {
+    return parseHandTextWith(bestHandParserKernel(), data, length, codes, capacity);
+}
+
+bool readHandFile(const std::string& path, std::vector<uint8_t>& codes) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (file.fail()) return false;
+
+    std::vector<char> text(size_t(file.tellg()));
+    file.seekg(0);
+    file.read(text.data(), text.size());
+
+    codes.resize(maxCardsInText(text.size()));
+    HandParseResult result = parseHandText(text.data(), text.size(), codes.data(), codes.size());
+    codes.resize(result.cards);
+    return result.ok;
+}
@@ -0,0 +1,42 @@
+// hand_parser.h
+// Author: Yusen Liu
+// Bulk parser for text hand files ("h 10\nc a\n...") that turns a whole buffer
+// into packed card codes (see Card::toCode) in one pass. Delimiters are found 32
+// bytes at a time with SSE2 or AVX2 when the CPU has them, with a scalar fallback;
+// suit and value tokens are mapped to codes through lookup tables.
+
+#ifndef HAND_PARSER_H
+#define HAND_PARSER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum HandParserKernel { PARSER_SCALAR, PARSER_SSE2, PARSER_AVX2 };
+
+struct HandParseResult {
+    size_t cards;        // codes written
+    bool ok;             // false on a malformed token or a suit without a value
+    size_t errorOffset;  // byte offset of the offending token when !ok
+};
+
+// Fastest kernel this CPU supports (checked once at runtime)
+HandParserKernel bestHandParserKernel();
+bool handParserKernelSupported(HandParserKernel kernel);
+const char* handParserKernelName(HandParserKernel kernel);
+
+// Upper bound on the number of cards a buffer of this length can hold, for
+// sizing the output array
+size_t maxCardsInText(size_t length);
+
+// Parse length bytes of text into codes[0..capacity). Stops at the first error.
+HandParseResult parseHandText(const char* data, size_t length, uint8_t* codes, size_t capacity);
+HandParseResult parseHandTextWith(HandParserKernel kernel, const char* data, size_t length,
+                                  uint8_t* codes, size_t capacity);
+
+// Read a whole text hand file and parse it. Returns false if the file can't be
+// read or doesn't parse.
+bool readHandFile(const std::string& path, std::vector<uint8_t>& codes);
+
+#endif
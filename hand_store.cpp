@@ -0,0 +1,318 @@
+// hand_store.cpp
+// Author: Yusen Liu
+// Implementation of the classes defined in hand_store.h
+
+#include "hand_store.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(std::bidirectional_iterator<HandView::Iterator>);
+static_assert(std::bidirectional_iterator<HandView::ReverseIterator>);
+
+// ====== Helper Functions ======
+
+static void putLittle(uint8_t* out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out[i] = uint8_t(value >> (8 * i));
+    }
+}
+
+static uint64_t getLittle(const uint8_t* in, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value |= uint64_t(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+// fsync the directory holding path, so a rename in it is durable
+static void syncDirectory(const std::string& path) {
+    size_t slash = path.rfind('/');
+    std::string dir = slash == std::string::npos ? "." : path.substr(0, slash + 1);
+    int fd = ::open(dir.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        fsync(fd);
+        ::close(fd);
+    }
+}
+
+// Copies of a card in a count table, and the first code held at or after from
+// (52 if none) and the last at or before from (-1 if none)
+static uint32_t copiesOf(const uint8_t* counts, int code) {
+    return uint32_t(getLittle(counts + 4 * code, 4));
+}
+
+static int nextHeld(const uint8_t* counts, int from) {
+    for (int code = from < 0 ? 0 : from; code < 52; code++) {
+        if (copiesOf(counts, code) != 0) return code;
+    }
+    return 52;
+}
+
+static int prevHeld(const uint8_t* counts, int from) {
+    for (int code = from > 51 ? 51 : from; code >= 0; code--) {
+        if (copiesOf(counts, code) != 0) return code;
+    }
+    return -1;
+}
+
+// ====== Iterator Methods ======
+
+HandView::Iterator& HandView::Iterator::operator++() {
+    if (code >= 52) return *this;
+    if (copy + 1 < copiesOf(counts, code)) {
+        copy++;
+    } else {
+        code = nextHeld(counts, code + 1);
+        copy = 0;
+    }
+    return *this;
+}
+
+HandView::Iterator HandView::Iterator::operator++(int) {
+    Iterator old = *this;
+    ++*this;
+    return old;
+}
+
+HandView::Iterator& HandView::Iterator::operator--() {
+    // end() steps back to the last copy of the largest card
+    if (copy > 0 && code < 52) {
+        copy--;
+    } else {
+        code = prevHeld(counts, code - 1);
+        copy = code >= 0 ? copiesOf(counts, code) - 1 : 0;
+    }
+    return *this;
+}
+
+HandView::Iterator HandView::Iterator::operator--(int) {
+    Iterator old = *this;
+    --*this;
+    return old;
+}
+
+const Card& HandView::Iterator::operator*() const {
+    return FULL_DECK[code];
+}
+
+const Card* HandView::Iterator::operator->() const {
+    return &FULL_DECK[code];
+}
+
+bool HandView::Iterator::operator==(const Iterator& other) const {
+    return code == other.code && copy == other.copy;
+}
+
+bool HandView::Iterator::operator!=(const Iterator& other) const {
+    return !(*this == other);
+}
+
+// ====== HandView Methods ======
+
+HandView::Iterator HandView::find(const Card& card) const {
+    return contains(card) ? Iterator(counts, card.toCode(), 0) : end();
+}
+
+bool HandView::contains(const Card& card) const {
+    return count(card) != 0;
+}
+
+size_t HandView::count(const Card& card) const {
+    int code = card.toCode();
+    return code >= 0 && counts ? copiesOf(counts, code) : 0;
+}
+
+HandView::Iterator HandView::begin() const {
+    return Iterator(counts, counts ? nextHeld(counts, 0) : 52, 0);
+}
+
+HandView::Iterator HandView::end() const {
+    return Iterator(counts, 52, 0);
+}
+
+HandView::ReverseIterator HandView::rbegin() const {
+    return ReverseIterator(end());
+}
+
+HandView::ReverseIterator HandView::rend() const {
+    return ReverseIterator(begin());
+}
+
+bool HandView::empty() const {
+    return cardCount == 0;
+}
+
+size_t HandView::getSize() const {
+    return cardCount;
+}
+
+size_t HandView::size() const {
+    return cardCount;
+}
+
+std::string_view HandView::name() const {
+    return handName;
+}
+
+// ====== HandStore Methods ======
+
+HandStore::HandStore() : base(nullptr), length(0), hands(0) {}
+
+HandStore::~HandStore() {
+    close();
+}
+
+bool HandStore::open(const std::string& path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || size_t(info.st_size) < HAND_STORE_HEADER_SIZE) {
+        ::close(fd);
+        return false;
+    }
+    size_t size = size_t(info.st_size);
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);    // the mapping keeps the file open
+    if (mapped == MAP_FAILED) return false;
+    base = (const uint8_t*)mapped;
+    length = size;
+
+    bool ok = memcmp(base, "HANDSTOR", 8) == 0 && getLittle(base + 8, 4) == HAND_STORE_VERSION
+              && getLittle(base + 16, 8) == length;
+    hands = uint32_t(getLittle(base + 12, 4));
+    ok = ok && HAND_STORE_HEADER_SIZE + uint64_t(hands) * HAND_STORE_ENTRY_SIZE <= length;
+    if (!ok) close();
+    return ok;
+}
+
+void HandStore::close() {
+    if (base) munmap((void*)base, length);
+    base = nullptr;
+    length = 0;
+    hands = 0;
+}
+
+bool HandStore::isOpen() const {
+    return base != nullptr;
+}
+
+size_t HandStore::handCount() const {
+    return hands;
+}
+
+bool HandStore::entry(size_t i, const uint8_t*& counts, std::string_view& name, size_t& cards) const {
+    if (i >= hands) return false;
+    const uint8_t* at = base + HAND_STORE_HEADER_SIZE + i * HAND_STORE_ENTRY_SIZE;
+    uint64_t countsOffset = getLittle(at, 8);
+    uint64_t nameOffset = getLittle(at + 8, 8);
+    uint64_t nameLength = getLittle(at + 16, 4);
+    if (countsOffset > length || length - countsOffset < 52 * 4) return false;
+    if (nameOffset > length || length - nameOffset < nameLength) return false;
+    counts = base + countsOffset;
+    name = std::string_view((const char*)base + nameOffset, nameLength);
+    cards = getLittle(at + 20, 4);
+    return true;
+}
+
+bool HandStore::hand(size_t i, HandView& view) const {
+    const uint8_t* counts;
+    std::string_view name;
+    size_t cards;
+    if (!entry(i, counts, name, cards)) return false;
+
+    // The card count must agree with the table, or size() and iteration would differ
+    uint64_t total = 0;
+    for (int code = 0; code < 52; code++) {
+        total += copiesOf(counts, code);
+    }
+    if (total != cards) return false;
+    view = HandView(counts, cards, name);
+    return true;
+}
+
+bool HandStore::findHand(std::string_view name, HandView& view) const {
+    for (size_t i = 0; i < hands; i++) {
+        const uint8_t* counts;
+        std::string_view candidate;
+        size_t cards;
+        if (entry(i, counts, candidate, cards) && candidate == name) return hand(i, view);
+    }
+    return false;
+}
+
+// ====== Building ======
+
+bool buildHandStore(const std::string& path, const std::vector<std::string>& names,
+                    const std::vector<std::vector<uint8_t>>& hands) {
+    if (names.size() != hands.size()) return false;
+    size_t count = hands.size();
+
+    // Count tables right after the index, names after the tables
+    size_t tablesOffset = HAND_STORE_HEADER_SIZE + count * HAND_STORE_ENTRY_SIZE;
+    size_t namesOffset = tablesOffset + count * 52 * 4;
+    size_t size = namesOffset;
+    for (const std::string& name : names) {
+        size += name.size();
+    }
+
+    std::vector<uint8_t> out(size, 0);
+    memcpy(out.data(), "HANDSTOR", 8);
+    putLittle(out.data() + 8, HAND_STORE_VERSION, 4);
+    putLittle(out.data() + 12, count, 4);
+    putLittle(out.data() + 16, size, 8);
+
+    size_t nameAt = namesOffset;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t copies[52] = {0};
+        for (uint8_t code : hands[i]) {
+            if (code >= 52) return false;
+            copies[code]++;
+        }
+        uint8_t* table = out.data() + tablesOffset + i * 52 * 4;
+        for (int code = 0; code < 52; code++) {
+            putLittle(table + 4 * code, copies[code], 4);
+        }
+        memcpy(out.data() + nameAt, names[i].data(), names[i].size());
+
+        uint8_t* entry = out.data() + HAND_STORE_HEADER_SIZE + i * HAND_STORE_ENTRY_SIZE;
+        putLittle(entry, tablesOffset + i * 52 * 4, 8);
+        putLittle(entry + 8, nameAt, 8);
+        putLittle(entry + 16, names[i].size(), 4);
+        putLittle(entry + 20, hands[i].size(), 4);
+        nameAt += names[i].size();
+    }
+
+    // Never rewrite the file in place: processes that have it mapped would fault
+    // past a truncated end. The new store goes to path.tmp and is renamed over
+    // path, so existing mappings keep the old inode and new opens see the new one.
+    std::string tmp = path + ".tmp";
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    const uint8_t* at = out.data();
+    size_t left = out.size();
+    bool ok = true;
+    while (ok && left > 0) {
+        ssize_t written = write(fd, at, left);
+        if (written < 0 && errno == EINTR) continue;
+        ok = written > 0;
+        if (ok) {
+            at += written;
+            left -= size_t(written);
+        }
+    }
+    ok = ok && fsync(fd) == 0;
+    ok = ::close(fd) == 0 && ok;
+    if (!ok || rename(tmp.c_str(), path.c_str()) != 0) {
+        unlink(tmp.c_str());
+        return false;
+    }
+    syncDirectory(path);
+    return true;
+}
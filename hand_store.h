@@ -0,0 +1,144 @@
+// hand_store.h
+// Author: Yusen Liu
+// A read-only store of many named hands in one file, for worker processes that
+// all play from the same corpus. The file is built once ("handstore build") and
+// then mapped with mmap by every worker: nothing is parsed or copied at startup,
+// the page cache holds one copy for all processes, and a hand is only touched
+// when it is looked at.
+//
+// Everything in the file is located by byte offsets from its start, never by
+// pointers, so it can be mapped at any address. Each hand is stored as its copy
+// count per card, which is all a sorted multiset of cards needs.
+//
+// Store layout (little-endian):
+//   0  char[8]  magic "HANDSTOR"
+//   8  uint32   version (1)
+//   12 uint32   hand count
+//   16 uint64   file size
+//   24 index    hand count entries of 24 bytes:
+//                 0  uint64 offset of the counts (52 x uint32, in card code order)
+//                 8  uint64 offset of the name
+//                 16 uint32 name length
+//                 20 uint32 card count
+//   then the count tables (4-byte aligned) and the names
+
+#ifndef HAND_STORE_H
+#define HAND_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "card.h"
+
+const uint32_t HAND_STORE_VERSION = 1;
+const size_t HAND_STORE_HEADER_SIZE = 24;
+const size_t HAND_STORE_ENTRY_SIZE = 24;
+
+// A zero-copy view of one hand in a mapped store, with CardList's read-only
+// interface. Valid while the HandStore that made it stays open.
+class HandView {
+private:
+    const uint8_t* counts;      // 52 little-endian uint32 inside the mapping
+    size_t cardCount;
+    std::string_view handName;
+
+public:
+    // Iterators visit every copy of a card in card order. They point into the
+    // mapping, not at the view, so they outlive the HandView they came from.
+    class Iterator {
+    private:
+        const uint8_t* counts;
+        int code;       // 52 at end
+        uint32_t copy;
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = Card;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Card*;
+        using reference = const Card&;
+
+        Iterator(const uint8_t* t = nullptr, int c = 52, uint32_t cp = 0) : counts(t), code(c), copy(cp) {}
+
+        // Prefix/postfix increment (operator++)
+        Iterator& operator++();
+        Iterator operator++(int);
+
+        // Prefix/postfix decrement (operator--)
+        Iterator& operator--();
+        Iterator operator--(int);
+
+        // Dereference (cards live in FULL_DECK)
+        const Card& operator*() const;
+        const Card* operator->() const;
+
+        // Equality/inequality
+        bool operator==(const Iterator& other) const;
+        bool operator!=(const Iterator& other) const;
+    };
+
+    using ReverseIterator = std::reverse_iterator<Iterator>;
+
+    HandView() : counts(nullptr), cardCount(0) {}
+    HandView(const uint8_t* c, size_t count, std::string_view name) : counts(c), cardCount(count), handName(name) {}
+
+    // Queries
+    Iterator find(const Card& card) const;
+    bool contains(const Card& card) const;
+    size_t count(const Card& card) const;
+
+    // Iterator support
+    Iterator begin() const;
+    Iterator end() const;
+    ReverseIterator rbegin() const;
+    ReverseIterator rend() const;
+
+    // Utility
+    bool empty() const;
+    size_t getSize() const;
+    size_t size() const;
+    std::string_view name() const;
+};
+
+// An open store file, mapped read-only
+class HandStore {
+private:
+    const uint8_t* base;
+    size_t length;
+    uint32_t hands;
+
+    // Read index entry i, checking that it points inside the file
+    bool entry(size_t i, const uint8_t*& counts, std::string_view& name, size_t& cards) const;
+
+public:
+    HandStore();
+    ~HandStore();
+    HandStore(const HandStore&) = delete;
+    HandStore& operator=(const HandStore&) = delete;
+
+    // Map a store file. Only the header is checked here, so opening costs the
+    // same however many hands there are; each hand is checked when it is viewed.
+    // False on any error, leaving the store closed.
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const;
+
+    size_t handCount() const;
+
+    // View of hand i. False if i is out of range, its entry points outside the
+    // file or its counts don't add up to its card count.
+    bool hand(size_t i, HandView& view) const;
+
+    // View of the hand with this name (the first one, if several share it; a
+    // linear scan of the index)
+    bool findHand(std::string_view name, HandView& view) const;
+};
+
+// Write a store holding hands[i] (card codes, any order) under names[i]
+bool buildHandStore(const std::string& path, const std::vector<std::string>& names,
+                    const std::vector<std::vector<uint8_t>>& hands);
+
+#endif
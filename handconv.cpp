@@ -0,0 +1,47 @@
+// handconv.cpp
+// Author: Yusen Liu
+// Convert hand files between the text format and the binary .hand format.
+// A text input is written as binary (sorted, so it bulk-loads); a binary input
+// is written back as text.
+// Usage: ./handconv [--masks] input output
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "hand_file.h"
+
+using namespace std;
+
+int main(int argv, char** argc) {
+    bool useMasks = false;
+    vector<string> files;
+    for (int i = 1; i < argv; i++) {
+        string arg = argc[i];
+        if (arg == "--masks") {
+            useMasks = true;
+        } else {
+            files.push_back(arg);
+        }
+    }
+
+    if (files.size() != 2) {
+        cout << "Usage: handconv [--masks] input output" << endl;
+        return 1;
+    }
+
+    vector<uint8_t> codes;
+    bool sorted = false;
+    bool binaryInput = isBinaryHandFile(files[0]);
+    if (!readHand(files[0], codes, sorted)) {
+        cout << "Could not read hand file " << files[0] << endl;
+        return 1;
+    }
+
+    bool written = binaryInput ? writeTextHand(files[1], codes)
+                               : writeBinaryHand(files[1], codes, useMasks);
+    if (!written) {
+        cout << "Could not write hand file " << files[1] << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,79 @@
+// handstore.cpp
+// Author: Yusen Liu
+// Build or inspect a hand store (see hand_store.h). Each input hand file, text or
+// binary, becomes one hand named by its path as given, loaded the way game loads
+// it (bad cards in text hands follow --on-error, as in game).
+// Usage: ./handstore build [--on-error=reject|skip] output.store hand1 hand2 ...
+//        ./handstore list input.store
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "hand_file.h"
+#include "hand_store.h"
+
+using namespace std;
+
+int main(int argv, char** argc) {
+    string mode = argv > 1 ? argc[1] : "";
+
+    BadCardPolicy policy = REJECT_BAD_CARDS;
+    vector<string> files;
+    for (int i = 2; i < argv; i++) {
+        string arg = argc[i];
+        if (arg.rfind("--on-error=", 0) == 0) {
+            if (!parseBadCardPolicy(arg.substr(11), policy)) {
+                cout << "--on-error must be reject or skip" << endl;
+                return 1;
+            }
+        } else {
+            files.push_back(arg);
+        }
+    }
+
+    if (mode == "build" && !files.empty()) {
+        vector<string> names;
+        vector<vector<uint8_t>> hands;
+        for (size_t i = 1; i < files.size(); i++) {
+            vector<Card> cards;
+            bool sorted = false;
+            if (!loadHandCards(files[i], policy, 1, cards, sorted, cerr)) {
+                cout << "Could not read hand file " << files[i] << endl;
+                return 1;
+            }
+            vector<uint8_t> codes;
+            codes.reserve(cards.size());
+            for (const Card& card : cards) {
+                codes.push_back(uint8_t(card.toCode()));
+            }
+            names.push_back(files[i]);
+            hands.push_back(move(codes));
+        }
+        if (!buildHandStore(files[0], names, hands)) {
+            cout << "Could not write hand store " << files[0] << endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    if (mode == "list" && argv == 3) {
+        HandStore store;
+        if (!store.open(argc[2])) {
+            cout << "Could not open hand store " << argc[2] << endl;
+            return 1;
+        }
+        for (size_t i = 0; i < store.handCount(); i++) {
+            HandView hand;
+            if (!store.hand(i, hand)) {
+                cout << "Hand " << i << " is corrupt" << endl;
+                return 1;
+            }
+            cout << hand.name() << ": " << hand.size() << " cards" << endl;
+        }
+        return 0;
+    }
+
+    cout << "Usage: handstore build [--on-error=reject|skip] output.store hand1 hand2 ..." << endl;
+    cout << "       handstore list input.store" << endl;
+    return 1;
+}
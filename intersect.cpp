@@ -0,0 +1,242 @@
+// intersect.cpp
+// Author: Yusen Liu
+// Implementation of the functions declared in intersect.h
+
+#include "intersect.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define INTERSECT_X86 1
+#endif
+
+// Gallop instead of merging once one side is this many times longer
+static const size_t GALLOP_RATIO = 32;
+
+// ====== Scalar Kernels ======
+
+// Plain merge, starting from a[i], b[j] with the counts so far in result
+static IntersectResult mergeTail(const uint16_t* a, size_t na, size_t i, const uint16_t* b, size_t nb, size_t j,
+                                 uint16_t* shared, uint16_t* onlyA, uint16_t* onlyB, IntersectResult result) {
+    while (i < na && j < nb) {
+        uint16_t x = a[i];
+        uint16_t y = b[j];
+        if (x < y) {
+            onlyA[result.onlyA++] = x;
+            i++;
+        } else if (y < x) {
+            onlyB[result.onlyB++] = y;
+            j++;
+        } else {
+            shared[result.shared++] = x;
+            i++;
+            j++;
+        }
+    }
+    memcpy(onlyA + result.onlyA, a + i, (na - i) * sizeof(uint16_t));
+    result.onlyA += na - i;
+    memcpy(onlyB + result.onlyB, b + j, (nb - j) * sizeof(uint16_t));
+    result.onlyB += nb - j;
+    return result;
+}
+
+// small is much shorter than large: find each of its keys by exponential search
+// and copy the skipped stretches of large in bulk
+static IntersectResult gallop(const uint16_t* small, size_t ns, const uint16_t* large, size_t nl,
+                              uint16_t* shared, uint16_t* onlySmall, uint16_t* onlyLarge) {
+    IntersectResult result = {0, 0, 0};     // onlyA counts small, onlyB counts large
+    size_t j = 0;
+    for (size_t i = 0; i < ns; i++) {
+        uint16_t key = small[i];
+
+        // Double the stride until large[hi] >= key, then binary search the last stride
+        size_t lo = j;
+        size_t hi = j;
+        size_t step = 1;
+        while (hi < nl && large[hi] < key) {
+            lo = hi + 1;
+            hi += step;
+            step *= 2;
+        }
+        size_t pos = std::lower_bound(large + lo, large + std::min(hi, nl), key) - large;
+
+        memcpy(onlyLarge + result.onlyB, large + j, (pos - j) * sizeof(uint16_t));
+        result.onlyB += pos - j;
+        j = pos;
+        if (pos < nl && large[pos] == key) {
+            shared[result.shared++] = key;
+            j++;
+        } else {
+            onlySmall[result.onlyA++] = key;
+        }
+    }
+    memcpy(onlyLarge + result.onlyB, large + j, (nl - j) * sizeof(uint16_t));
+    result.onlyB += nl - j;
+    return result;
+}
+
+// ====== SSE4.2 Kernel ======
+
+#ifdef INTERSECT_X86
+// Send the matched keys of a finished 8-key block to shared (dropped when
+// shared is null) and the rest to only. Runs of one card's copies usually
+// leave whole blocks matched or unmatched, so those are single copies.
+static inline void flushBlock(const uint16_t* block, unsigned matched, uint16_t* shared, size_t& sharedCount,
+                              uint16_t* only, size_t& onlyCount) {
+    if (matched == 0) {
+        memcpy(only + onlyCount, block, 8 * sizeof(uint16_t));
+        onlyCount += 8;
+    } else if (matched == 0xFF) {
+        if (shared) {
+            memcpy(shared + sharedCount, block, 8 * sizeof(uint16_t));
+            sharedCount += 8;
+        }
+    } else {
+        for (int k = 0; k < 8; k++) {
+            if (!((matched >> k) & 1)) {
+                only[onlyCount++] = block[k];
+            } else if (shared) {
+                shared[sharedCount++] = block[k];
+            }
+        }
+    }
+}
+
+__attribute__((target("sse4.2")))
+static IntersectResult blockCompareSse42(const uint16_t* a, size_t na, const uint16_t* b, size_t nb,
+                                         uint16_t* shared, uint16_t* onlyA, uint16_t* onlyB) {
+    const int mode = _SIDD_UWORD_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_BIT_MASK;
+    IntersectResult result = {0, 0, 0};
+    size_t i = 0;
+    size_t j = 0;
+    unsigned matchedA = 0;  // keys of the current a block found in some b block so far
+    unsigned matchedB = 0;
+
+    while (i + 8 <= na && j + 8 <= nb) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + j));
+        matchedA |= _mm_cvtsi128_si32(_mm_cmpestrm(vb, 8, va, 8, mode));
+        matchedB |= _mm_cvtsi128_si32(_mm_cmpestrm(va, 8, vb, 8, mode));
+
+        // The block ending lower can't meet any later block of the other side
+        uint16_t lastA = a[i + 7];
+        uint16_t lastB = b[j + 7];
+        if (lastA <= lastB) {
+            flushBlock(a + i, matchedA, shared, result.shared, onlyA, result.onlyA);
+            i += 8;
+            matchedA = 0;
+        }
+        if (lastB <= lastA) {
+            flushBlock(b + j, matchedB, nullptr, result.shared, onlyB, result.onlyB);
+            j += 8;
+            matchedB = 0;
+        }
+    }
+
+    // Finish the partly compared blocks: keys already matched are settled, the
+    // rest can only match keys from here on
+    while (i < na && j < nb) {
+        if (matchedA & 1) {
+            shared[result.shared++] = a[i++];
+            matchedA >>= 1;
+        } else if (matchedB & 1) {
+            j++;
+            matchedB >>= 1;
+        } else if (a[i] < b[j]) {
+            onlyA[result.onlyA++] = a[i++];
+            matchedA >>= 1;
+        } else if (b[j] < a[i]) {
+            onlyB[result.onlyB++] = b[j++];
+            matchedB >>= 1;
+        } else {
+            shared[result.shared++] = a[i++];
+            j++;
+            matchedA >>= 1;
+            matchedB >>= 1;
+        }
+    }
+    for (; i < na; i++, matchedA >>= 1) {
+        if (matchedA & 1) {
+            shared[result.shared++] = a[i];
+        } else {
+            onlyA[result.onlyA++] = a[i];
+        }
+    }
+    for (; j < nb; j++, matchedB >>= 1) {
+        if (!(matchedB & 1)) onlyB[result.onlyB++] = b[j];
+    }
+    return result;
+}
+#endif
+
+// ====== Public Functions ======
+
+bool intersectKernelSupported(IntersectKernel kernel) {
+#ifdef INTERSECT_X86
+    __builtin_cpu_init();
+#endif
+    switch (kernel) {
+        case INTERSECT_SCALAR:
+            return true;
+#ifdef INTERSECT_X86
+        case INTERSECT_SSE42:
+            return __builtin_cpu_supports("sse4.2");
+#endif
+        default:
+            return false;
+    }
+}
+
+IntersectKernel bestIntersectKernel() {
+    static const IntersectKernel best = intersectKernelSupported(INTERSECT_SSE42) ? INTERSECT_SSE42 : INTERSECT_SCALAR;
+    return best;
+}
+
+const char* intersectKernelName(IntersectKernel kernel) {
+    return kernel == INTERSECT_SSE42 ? "sse4.2" : "scalar";
+}
+
+bool packHand(const uint8_t* codes, size_t count, std::vector<uint16_t>& keys) {
+    keys.resize(count);
+    unsigned copy = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (codes[i] >= 52) return false;
+        if (i > 0 && codes[i] < codes[i - 1]) return false;
+        copy = i > 0 && codes[i] == codes[i - 1] ? copy + 1 : 0;
+        if (copy >= 1u << PACKED_COPY_BITS) return false;
+        keys[i] = uint16_t(codes[i] << PACKED_COPY_BITS | copy);
+    }
+    return true;
+}
+
+IntersectResult intersectPackedWith(IntersectKernel kernel, const uint16_t* a, size_t na,
+                                    const uint16_t* b, size_t nb,
+                                    uint16_t* shared, uint16_t* onlyA, uint16_t* onlyB) {
+    // Lopsided sizes: searching beats comparing every key
+    if (na * GALLOP_RATIO < nb) return gallop(a, na, b, nb, shared, onlyA, onlyB);
+    if (nb * GALLOP_RATIO < na) {
+        IntersectResult r = gallop(b, nb, a, na, shared, onlyB, onlyA);
+        return IntersectResult{r.shared, r.onlyB, r.onlyA};
+    }
+#ifdef INTERSECT_X86
+    if (kernel == INTERSECT_SSE42) return blockCompareSse42(a, na, b, nb, shared, onlyA, onlyB);
+#endif
+    return mergeTail(a, na, 0, b, nb, 0, shared, onlyA, onlyB, IntersectResult{0, 0, 0});
+}
+
+IntersectResult intersectPacked(const uint16_t* a, size_t na, const uint16_t* b, size_t nb,
+                                uint16_t* shared, uint16_t* onlyA, uint16_t* onlyB) {
+    return intersectPackedWith(bestIntersectKernel(), a, na, b, nb, shared, onlyA, onlyB);
+}
+
+void intersectHands(const std::vector<uint16_t>& a, const std::vector<uint16_t>& b,
+                    std::vector<uint16_t>& shared, std::vector<uint16_t>& onlyA, std::vector<uint16_t>& onlyB) {
+    shared.resize(std::min(a.size(), b.size()));
+    onlyA.resize(a.size());
+    onlyB.resize(b.size());
+    IntersectResult r = intersectPacked(a.data(), a.size(), b.data(), b.size(), shared.data(), onlyA.data(), onlyB.data());
+    shared.resize(r.shared);
+    onlyA.resize(r.onlyA);
+    onlyB.resize(r.onlyB);
+}
@@ -0,0 +1,59 @@
+// intersect.h
+// Author: Yusen Liu
+// Intersection of two hands stored as sorted arrays of packed cards, returning
+// the shared cards and what is left of each hand in one pass.
+//
+// A multi-deck hand becomes a strictly ascending key array by numbering the
+// copies of each card: key = code << 10 | copy. Copy k of a card is in both
+// hands exactly when both hold more than k copies, so a plain set intersection
+// of the keys is the multiset intersection of the hands.
+//
+// The SSE4.2 kernel compares 8x8 keys per pcmpestrm (block compare, advancing
+// whichever block ends lower); when one hand is much smaller than the other,
+// galloping (exponential search) skips through the large one instead. Scalar
+// merge is the fallback.
+
+#ifndef INTERSECT_H
+#define INTERSECT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum IntersectKernel { INTERSECT_SCALAR, INTERSECT_SSE42 };
+
+static constexpr int PACKED_COPY_BITS = 10;     // up to 1024 copies of a card
+
+struct IntersectResult {
+    size_t shared;      // keys written to each output
+    size_t onlyA;
+    size_t onlyB;
+};
+
+// Fastest kernel this CPU supports (checked once at runtime)
+IntersectKernel bestIntersectKernel();
+bool intersectKernelSupported(IntersectKernel kernel);
+const char* intersectKernelName(IntersectKernel kernel);
+
+// Number the copies of an ascending code array. Returns false for a code
+// outside 0..51, a descending code, or more than 1024 copies of one card.
+bool packHand(const uint8_t* codes, size_t count, std::vector<uint16_t>& keys);
+
+inline int packedCode(uint16_t key) {
+    return key >> PACKED_COPY_BITS;
+}
+
+// Split two strictly ascending key arrays into shared keys and the keys only
+// one side holds, all ascending. shared needs room for min(na, nb) keys, onlyA
+// for na and onlyB for nb.
+IntersectResult intersectPacked(const uint16_t* a, size_t na, const uint16_t* b, size_t nb,
+                                uint16_t* shared, uint16_t* onlyA, uint16_t* onlyB);
+IntersectResult intersectPackedWith(IntersectKernel kernel, const uint16_t* a, size_t na,
+                                    const uint16_t* b, size_t nb,
+                                    uint16_t* shared, uint16_t* onlyA, uint16_t* onlyB);
+
+// Same, sizing the output vectors
+void intersectHands(const std::vector<uint16_t>& a, const std::vector<uint16_t>& b,
+                    std::vector<uint16_t>& shared, std::vector<uint16_t>& onlyA, std::vector<uint16_t>& onlyB);
+
+#endif
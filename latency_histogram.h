@@ -0,0 +1,76 @@
+// latency_histogram.h
+// Author: Yusen Liu
+// Lock-free latency histogram for the game daemon and its load generator.
+// Buckets are log-linear: exact below 8 us, then 8 buckets per power of two, so
+// any percentile is within 12.5% of the true value. Recording is one relaxed
+// atomic increment, safe from any number of threads.
+
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <atomic>
+#include <cstdint>
+
+class LatencyHistogram {
+private:
+    static constexpr int SUB_BUCKETS = 8;
+    static constexpr int BUCKETS = 62 * SUB_BUCKETS;
+
+    std::atomic<uint64_t> counts[BUCKETS];
+    std::atomic<uint64_t> samples;
+    std::atomic<uint64_t> sum;
+
+    static int bucketOf(uint64_t micros) {
+        if (micros < SUB_BUCKETS) return int(micros);
+        int octave = 63 - __builtin_clzll(micros);      // >= 3
+        int sub = int(micros >> (octave - 3)) & (SUB_BUCKETS - 1);
+        int bucket = (octave - 2) * SUB_BUCKETS + sub;
+        return bucket < BUCKETS ? bucket : BUCKETS - 1;
+    }
+
+    // Smallest value that falls in a bucket
+    static uint64_t bucketFloor(int bucket) {
+        if (bucket < SUB_BUCKETS) return uint64_t(bucket);
+        int octave = bucket / SUB_BUCKETS + 2;
+        int sub = bucket % SUB_BUCKETS;
+        return uint64_t(SUB_BUCKETS + sub) << (octave - 3);
+    }
+
+public:
+    LatencyHistogram() : samples(0), sum(0) {
+        for (auto& count : counts) {
+            count.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void record(uint64_t micros) {
+        counts[bucketOf(micros)].fetch_add(1, std::memory_order_relaxed);
+        samples.fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(micros, std::memory_order_relaxed);
+    }
+
+    uint64_t count() const {
+        return samples.load(std::memory_order_relaxed);
+    }
+
+    uint64_t mean() const {
+        uint64_t n = count();
+        return n ? sum.load(std::memory_order_relaxed) / n : 0;
+    }
+
+    // Value at quantile q (0.5 for p50, 0.99 for p99), rounded down to its
+    // bucket; 0 with no samples
+    uint64_t percentile(double q) const {
+        uint64_t n = count();
+        if (n == 0) return 0;
+        uint64_t rank = uint64_t(q * double(n - 1)) + 1;
+        uint64_t seen = 0;
+        for (int b = 0; b < BUCKETS; b++) {
+            seen += counts[b].load(std::memory_order_relaxed);
+            if (seen >= rank) return bucketFloor(b);
+        }
+        return bucketFloor(BUCKETS - 1);
+    }
+};
+
+#endif
@@ -2,84 +2,328 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <vector>
+#include <thread>
+#include <future>
+#include <algorithm>
+#include <charconv>
 #include "card.h"
+#include "hand_file.h"
+#include "hand_store.h"
+#include "trace.h"
 #include "card_list.h"
+#include "game.h"
+#include "game_outcome.h"
+#include "intersect.h"
+#include "stream_game.h"
+#include "checkpoint.h"
+#include "game_daemon.h"
+#include "pick_log.h"
+#include <csignal>
 //Do not include set in this file
 
 using namespace std;
 
-int main(int argv, char** argc){
-  if(argv < 3){
-    std::cout << "Please provide 2 file names" << std::endl;
-    return 1;
+// Load a text or binary .hand file, parsing big text files on several threads.
+// Sorted input (binary files and split text files always are) goes straight into an O(n) balanced build instead of one insert per card.
+static bool loadHand(const std::string& path, CardList& hand, int threads, BadCardPolicy policy) {
+  TRACE_SCOPE("load hand");
+  std::vector<Card> cards;
+  bool sorted = false;
+  if (!loadHandCards(path, policy, threads, cards, sorted, std::cerr)) return false;
+  TRACE_SCOPE("build hand");
+  if (sorted) {
+    hand.assignSorted(cards.data(), cards.size());
+  } else {
+    for (const Card& card : cards) {
+      hand.insert(card);
+    }
   }
-  
-  std::ifstream cardFile1 (argc[1]);
-  std::ifstream cardFile2 (argc[2]);
-  std::string line;
+  return true;
+}
 
-  if (cardFile1.fail() || cardFile2.fail() ){
-    std::cout << "Could not open file " << argc[2];
-    return 1;
+// Load a hand as packed keys for the vectorized --fast path. False if the file
+// needs the validating fallback or a card can't be packed.
+static bool loadPacked(const std::string& path, std::vector<uint16_t>& keys, int threads) {
+  TRACE_SCOPE("load packed hand");
+  std::vector<Card> cards;
+  bool sorted = false;
+  if (!readHandCardsParallel(path, cards, sorted, threads)) return false;
+
+  std::vector<uint8_t> codes(cards.size());
+  for (size_t i = 0; i < cards.size(); i++) {
+    codes[i] = uint8_t(cards[i].toCode());
+  }
+  if (!sorted) std::sort(codes.begin(), codes.end());
+  return packHand(codes.data(), codes.size(), keys);
+}
+
+// Play the game turn by turn, also recording its picks to a pick log
+static bool playLogged(CardList& alice, CardList& bob, const std::string& logPath) {
+  CardCounts aliceStart = countCards(alice);
+  CardCounts bobStart = countCards(bob);
+  std::vector<Pick> picks;
+  playGame(alice, bob, std::cout, &picks);
+  TRACE_SCOPE("write pick log");
+  if (!writePickLog(logPath, makePickLog(aliceStart, bobStart, picks))) {
+    std::cerr << "Could not write pick log " << logPath << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// Play two hands from a hand store. --fast reads the mapped hands in place; the
+// turn-by-turn game needs hands it can erase from, so those are bulk-built copies.
+static int playFromStore(const std::string& path, const std::string& aliceName, const std::string& bobName, bool fast,
+                         const std::string& logPath) {
+  HandStore store;
+  HandView aliceView;
+  HandView bobView;
+  {
+    TRACE_SCOPE("open store");
+    if (!store.open(path)) {
+      std::cout << "Could not open hand store " << path << std::endl;
+      return 1;
+    }
+    if (!store.findHand(aliceName, aliceView)) {
+      std::cout << "No hand named " << aliceName << " in " << path << std::endl;
+      return 1;
+    }
+    if (!store.findHand(bobName, bobView)) {
+      std::cout << "No hand named " << bobName << " in " << path << std::endl;
+      return 1;
+    }
+  }
+
+  if (fast && logPath.empty()) {
+    playFast(aliceView, bobView, std::cout);
+    return 0;
   }
 
-  // Read cards into BSTs
   CardList alice;
   CardList bob;
+  {
+    TRACE_SCOPE("build hand");
+    std::vector<Card> cards(aliceView.begin(), aliceView.end());
+    alice.assignSorted(cards.data(), cards.size());
+    cards.assign(bobView.begin(), bobView.end());
+    bob.assignSorted(cards.data(), cards.size());
+  }
+  if (!logPath.empty()) return playLogged(alice, bob, logPath) ? 0 : 1;
+  playGame(alice, bob, std::cout);
+  return 0;
+}
+
+// Parse a whole argument as a positive number; false on anything else
+template <class T>
+static bool parsePositive(const char* text, T& value) {
+  const char* end = text + std::string(text).size();
+  auto [ptr, error] = std::from_chars(text, end, value);
+  return error == std::errc() && ptr == end && ptr != text && value > 0;
+}
+
+int main(int argv, char** argc){
+  // Usage: game [--fast] [--trace out.json] [--on-error=reject|skip] [--pick-log out.plog] [--threads N] cardFile1 cardFile2
+  //        game [--fast] [--trace out.json] [--on-error=reject|skip] --stream [--threads N] < games
+  //        game [--fast] [--trace out.json] [--pick-log out.plog] --store hands.store aliceHand bobHand
+  //        game [--fast] [--threads N] [--on-error=reject|skip] --input games --output results
+  //             [--checkpoint file [--checkpoint-every N] [--resume]]
+  // The last form is stream mode between files, checkpointing every N games
+  // (default 10000) so that --resume continues a killed run with the same output
+  //        game --daemon socket [--threads N] [--batch N]
+  // --pick-log records the picks in a compact log that replay checks against the
+  // hands; it plays turn by turn even with --fast
+  // The daemon serves games over a Unix socket (see game_daemon.h) until SIGINT
+  // or SIGTERM, then prints its metrics to stderr
+  // A bad card in a text hand fails the run (reject, the default) or is reported
+  // and dropped (skip); either way it is reported as file:line on stderr. In
+  // stream and --input mode a rejected game stops the run after the games before it
+  bool fast = false;
+  bool stream = false;
+  std::string tracePath;
+  std::string storePath;
+  std::string daemonPath;
+  std::string pickLogPath;
+  size_t daemonBatch = 32;
+  BatchOptions batch;
+  BadCardPolicy policy = REJECT_BAD_CARDS;
+  int threads = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<std::string> files;
+  for (int i = 1; i < argv; i++) {
+    std::string arg = argc[i];
+    if (arg == "--fast") {
+      fast = true;
+    } else if (arg == "--stream") {
+      stream = true;
+    } else if (arg == "--threads" && i + 1 < argv) {
+      if (!parsePositive(argc[++i], threads)) {
+        std::cerr << "--threads must be a positive number" << std::endl;
+        return 1;
+      }
+    } else if (arg == "--trace" && i + 1 < argv) {
+      tracePath = argc[++i];
+    } else if (arg == "--store" && i + 1 < argv) {
+      storePath = argc[++i];
+    } else if (arg == "--input" && i + 1 < argv) {
+      batch.input = argc[++i];
+    } else if (arg == "--output" && i + 1 < argv) {
+      batch.output = argc[++i];
+    } else if (arg == "--checkpoint" && i + 1 < argv) {
+      batch.checkpoint = argc[++i];
+    } else if (arg == "--checkpoint-every" && i + 1 < argv) {
+      if (!parsePositive(argc[++i], batch.checkpointEvery)) {
+        std::cerr << "--checkpoint-every must be a positive number" << std::endl;
+        return 1;
+      }
+    } else if (arg == "--pick-log" && i + 1 < argv) {
+      pickLogPath = argc[++i];
+    } else if (arg == "--daemon" && i + 1 < argv) {
+      daemonPath = argc[++i];
+    } else if (arg == "--batch" && i + 1 < argv) {
+      if (!parsePositive(argc[++i], daemonBatch)) {
+        std::cerr << "--batch must be a positive number" << std::endl;
+        return 1;
+      }
+    } else if (arg == "--resume") {
+      batch.resume = true;
+    } else if (arg.rfind("--on-error=", 0) == 0) {
+      if (!parseBadCardPolicy(arg.substr(11), policy)) {
+        std::cerr << "--on-error must be reject or skip" << std::endl;
+        return 1;
+      }
+    } else {
+      files.push_back(arg);
+    }
+  }
 
-  Card c;
-  while (cardFile1 >> c) {
-    alice.insert(c);
+  if (!tracePath.empty()) {
+    traceEnable();
+    traceThreadName("main");
   }
-  cardFile1.close();
 
-  while (cardFile2 >> c) {
-    bob.insert(c);
+  // Serve games until told to stop. The signals are blocked before any thread
+  // starts, so every thread inherits the mask and only sigwait sees them.
+  if (!daemonPath.empty()) {
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    GameDaemon daemon(daemonPath, threads, daemonBatch);
+    std::string error;
+    if (!daemon.start(error)) {
+      std::cerr << error << std::endl;
+      return 1;
+    }
+    int signal = 0;
+    sigwait(&signals, &signal);
+    daemon.stop();
+    std::cerr << formatMetrics(daemon.metrics());
+    if (!tracePath.empty() && !traceWrite(tracePath)) {
+      std::cerr << "Could not write trace " << tracePath << std::endl;
+    }
+    return 0;
   }
-  cardFile2.close();
 
-  // Play the game: alternate Alice (forward) then Bob (reverse)
-  while (true) {
-    bool picked = false;
+  // A stream file into a results file, resumable from checkpoints
+  if (!batch.input.empty()) {
+    if (batch.output.empty()) {
+      std::cout << "--input needs --output" << std::endl;
+      return 1;
+    }
+    batch.threads = threads;
+    batch.fast = fast;
+    batch.policy = policy;
+    std::string error;
+    bool ok = runBatch(batch, error);
+    if (!ok) std::cerr << error << std::endl;
+    if (!tracePath.empty() && !traceWrite(tracePath)) {
+      std::cerr << "Could not write trace " << tracePath << std::endl;
+    }
+    return ok ? 0 : 1;
+  }
 
-    // Alice's turn: iterate from smallest to largest
-    for (auto it = alice.begin(); it != alice.end(); ++it) {
-      if (bob.contains(*it)) {
-        std::cout << "Alice picked matching card " << *it << std::endl;
-        Card match = *it;
-        alice.erase(it);
-        bob.erase(match);
-        picked = true;
-        break;
-      }
+  // Many games concatenated on stdin, played by a parse/play/write pipeline
+  if (stream) {
+    bool played = runStream(std::cin, std::cout, threads, fast, {}, nullptr, policy);
+    if (!played) std::cerr << "Stopped at a bad card" << std::endl;
+    if (!tracePath.empty() && !traceWrite(tracePath)) {
+      std::cerr << "Could not write trace " << tracePath << std::endl;
     }
+    return played ? 0 : 1;
+  }
 
-    // Bob's turn: iterate from largest to smallest (always runs after Alice)
-    for (auto rit = bob.rbegin(); rit != bob.rend(); ++rit) {
-      if (alice.contains(*rit)) {
-        std::cout << "Bob picked matching card " << *rit << std::endl;
-        Card match = *rit;
-        bob.erase(match);
-        alice.erase(match);
-        picked = true;
-        break;
-      }
+  if(files.size() < 2){
+    std::cout << "Please provide 2 file names" << std::endl;
+    return 1;
+  }
+
+  // Hands named in a mapped store instead of files: nothing to parse
+  if (!storePath.empty()) {
+    int status = playFromStore(storePath, files[0], files[1], fast, pickLogPath);
+    if (!tracePath.empty() && !traceWrite(tracePath)) {
+      std::cerr << "Could not write trace " << tracePath << std::endl;
     }
+    return status;
+  }
+  
+  {
+    TRACE_SCOPE("open files");
+    std::ifstream cardFile1 (files[0]);
+    std::ifstream cardFile2 (files[1]);
 
-    if (!picked) break; // no more matches
+    if (cardFile1.fail() || cardFile2.fail() ){
+      std::cout << "Could not open file " << files[1];
+      return 1;
+    }
   }
 
-  std::cout << std::endl;
-  std::cout << "Alice's cards:" << std::endl;
-  for (auto it = alice.begin(); it != alice.end(); ++it) {
-    std::cout << *it << std::endl;
+  // Both files load at once, each splitting its parse over half the threads
+  int loaderThreads = std::max(1, threads / 2);
+
+  // --fast intersects sorted key arrays directly when both hands pack
+  if (fast && pickLogPath.empty()) {
+    std::vector<uint16_t> alicePacked;
+    std::vector<uint16_t> bobPacked;
+    auto bobPackedOk = std::async(std::launch::async, [&]() {
+      traceThreadName("load " + files[1]);
+      return loadPacked(files[1], bobPacked, loaderThreads);
+    });
+    bool aliceOk = loadPacked(files[0], alicePacked, loaderThreads);
+    if (bobPackedOk.get() && aliceOk) {
+      playFastPacked(alicePacked, bobPacked, std::cout);
+      if (!tracePath.empty() && !traceWrite(tracePath)) {
+        std::cerr << "Could not write trace " << tracePath << std::endl;
+      }
+      return 0;
+    }
   }
 
-  std::cout << std::endl;
-  std::cout << "Bob's cards:" << std::endl;
-  for (auto it = bob.begin(); it != bob.end(); ++it) {
-    std::cout << *it << std::endl;
+  // Read cards into BSTs
+  CardList alice;
+  CardList bob;
+  auto bobLoaded = std::async(std::launch::async, [&]() {
+    traceThreadName("load " + files[1]);
+    return loadHand(files[1], bob, loaderThreads, policy);
+  });
+  bool aliceLoaded = loadHand(files[0], alice, loaderThreads, policy);
+  if (!bobLoaded.get() || !aliceLoaded) {
+    return 1;
   }
 
-  return 0;
+  // --fast computes the same output in one merge pass instead of turn by turn
+  bool ok = true;
+  if (!pickLogPath.empty()) {
+    ok = playLogged(alice, bob, pickLogPath);
+  } else if (fast) {
+    playFast(alice, bob, std::cout);
+  } else {
+    playGame(alice, bob, std::cout);
+  }
+
+  if (!tracePath.empty() && !traceWrite(tracePath)) {
+    std::cerr << "Could not write trace " << tracePath << std::endl;
+  }
+  return ok ? 0 : 1;
 }
@@ -1,41 +1,96 @@
 // This file should implement the game using the std::set container class
+// (std::multiset, so hands from multi-deck shoes keep every copy)
 // Do not include card_list.h in this file
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <set>
+#include <vector>
+#include <thread>
+#include <future>
+#include <algorithm>
 #include "card.h"
+#include "hand_file.h"
+#include "trace.h"
+#include "game_outcome.h"
+#include "set_game.h"
 
 using namespace std;
 
+// Load a text or binary .hand file, parsing big text files on several threads.
+// Sorted input (binary files and split text files always are) is inserted in one linear pass instead of one search per card.
+static bool loadHand(const std::string& path, std::multiset<Card>& hand, int threads, BadCardPolicy policy) {
+  TRACE_SCOPE("load hand");
+  std::vector<Card> cards;
+  bool sorted = false;
+  if (!loadHandCards(path, policy, threads, cards, sorted, std::cerr)) return false;
+  TRACE_SCOPE("build hand");
+  if (sorted) {
+    hand = std::multiset<Card>(cards.begin(), cards.end());
+  } else {
+    hand.insert(cards.begin(), cards.end());
+  }
+  return true;
+}
+
 int main(int argv, char** argc){
-  if(argv < 3){
-    std::cout << "Please provide 2 file names" << std::endl;
-    return 1;
+  // Usage: game_set [--fast] [--trace out.json] [--on-error=reject|skip] cardFile1 cardFile2
+  // A bad card in a text hand fails the run (reject, the default) or is reported
+  // and dropped (skip); either way it is reported as file:line on stderr
+  bool fast = false;
+  std::string tracePath;
+  BadCardPolicy policy = REJECT_BAD_CARDS;
+  std::vector<std::string> files;
+  for (int i = 1; i < argv; i++) {
+    std::string arg = argc[i];
+    if (arg == "--fast") {
+      fast = true;
+    } else if (arg == "--trace" && i + 1 < argv) {
+      tracePath = argc[++i];
+    } else if (arg.rfind("--on-error=", 0) == 0) {
+      if (!parseBadCardPolicy(arg.substr(11), policy)) {
+        std::cerr << "--on-error must be reject or skip" << std::endl;
+        return 1;
+      }
+    } else {
+      files.push_back(arg);
+    }
+  }
+
+  if (!tracePath.empty()) {
+    traceEnable();
+    traceThreadName("main");
   }
-  
-  std::ifstream cardFile1 (argc[1]);
-  std::ifstream cardFile2 (argc[2]);
-  std::string line;
 
-  if (cardFile1.fail() || cardFile2.fail() ){
-    std::cout << "Could not open file " << argc[2];
+  if(files.size() < 2){
+    std::cout << "Please provide 2 file names" << std::endl;
     return 1;
   }
-  // Read cards into sets
-  std::set<Card> alice;
-  std::set<Card> bob;
+  
+  {
+    TRACE_SCOPE("open files");
+    std::ifstream cardFile1 (files[0]);
+    std::ifstream cardFile2 (files[1]);
 
-  Card c;
-  while (cardFile1 >> c) {
-    alice.insert(c);
+    if (cardFile1.fail() || cardFile2.fail() ){
+      std::cout << "Could not open file " << files[1];
+      return 1;
+    }
   }
-  cardFile1.close();
 
-  while (cardFile2 >> c) {
-    bob.insert(c);
+  // Read cards into multisets
+  std::multiset<Card> alice;
+  std::multiset<Card> bob;
+  // Both files load at once, each splitting its parse over half the cores
+  int loaderThreads = std::max(1u, std::thread::hardware_concurrency() / 2);
+  auto bobLoaded = std::async(std::launch::async, [&]() {
+    traceThreadName("load " + files[1]);
+    return loadHand(files[1], bob, loaderThreads, policy);
+  });
+  bool aliceLoaded = loadHand(files[0], alice, loaderThreads, policy);
+  if (!bobLoaded.get() || !aliceLoaded) {
+    return 1;
   }
-  cardFile2.close();
 
   // DEBUG: print initial hands (remove after verification)
   //cerr << "Initial Alice:" << endl;
@@ -43,52 +98,15 @@ int main(int argv, char** argc){
   //cerr << "Initial Bob:" << endl;
   //for (const auto &card : bob) cerr << card << endl;
 
-  // Play the game: alternate Alice (forward) then Bob (reverse)
-  while (true) {
-    bool picked = false;
-
-    // Alice's turn: iterate from smallest to largest
-    //why I used auto? because it is clean and it is easier to read, and it is more efficient than using set<Card>::iterator
-    ////'it' is a forward iterator, aka a pointer
-    for (auto it = alice.begin(); it != alice.end(); ++it) {
-      // Check if Bob has a matching card and it is not at the end of the set (to avoid erasing while iterating)
-      if (bob.find(*it) != bob.end()) {
-        std::cout << "Alice picked matching card " << *it << std::endl;
-        Card match = *it;
-        alice.erase(it);
-        bob.erase(match);
-        picked = true;
-        break;
-      }
-    }
-
-    // Bob's turn: iterate from largest to smallest (always runs after Alice)
-    //rit is the reverse iterator, which is also a pointer
-    for (auto rit = bob.rbegin(); rit != bob.rend(); ++rit) {
-      if (alice.find(*rit) != alice.end()) {
-        std::cout << "Bob picked matching card " << *rit << std::endl;
-        Card match = *rit;
-        bob.erase(match);
-        alice.erase(match);
-        picked = true;
-        break;
-      }
-    }
-
-    if (!picked) break; // no more matches
+  // --fast computes the same output in one merge pass instead of turn by turn
+  if (fast) {
+    playFast(alice, bob, std::cout);
+  } else {
+    playSetGame(alice, bob, std::cout);
   }
 
-  std::cout << std::endl;
-  std::cout << "Alice's cards:" << std::endl;
-  for (const auto &card : alice) {
-    std::cout << card << std::endl;
+  if (!tracePath.empty() && !traceWrite(tracePath)) {
+    std::cerr << "Could not write trace " << tracePath << std::endl;
   }
-
-  std::cout << std::endl;
-  std::cout << "Bob's cards:" << std::endl;
-  for (const auto &card : bob) {
-    std::cout << card << std::endl;
-  }
-
   return 0;
 }
@@ -0,0 +1,117 @@
+// main_tournament.cpp
+// Author: Yusen Liu
+// Play the matching game between any number of players.
+// Usage: ./tournament [--names A,B,...] [--order 0,2,1,...] [--dirs asc,desc,...]
+//                     [--on-error=reject|skip] file1 file2 ...
+// Names default to Alice, Bob, Player 3, ...; directions alternate asc, desc,
+// starting with asc; the turn order defaults to the order of the files.
+// With two files and no options the output is the same as game's.
+
+#include <iostream>
+#include <charconv>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "card.h"
+#include "hand_file.h"
+#include "tournament.h"
+
+using namespace std;
+
+static vector<string> splitList(const string& text) {
+    vector<string> items;
+    stringstream ss(text);
+    string item;
+    while (getline(ss, item, ',')) {
+        items.push_back(item);
+    }
+    return items;
+}
+
+// Text or binary .hand file, loaded as game loads it (see loadHandCards). Bad
+// cards are reported as file:line on stderr.
+static bool loadCards(const string& path, vector<Card>& cards, BadCardPolicy policy) {
+    if (ifstream(path).fail()) {
+        cout << "Could not open file " << path << endl;
+        return false;
+    }
+    bool sorted = false;
+    return loadHandCards(path, policy, 1, cards, sorted, cerr);
+}
+
+// A whole argument as a player number; false on anything else
+static bool parseIndex(const string& text, int& value) {
+    auto [end, error] = from_chars(text.data(), text.data() + text.size(), value);
+    return error == errc() && end == text.data() + text.size() && !text.empty();
+}
+
+int main(int argv, char** argc) {
+    vector<string> names;
+    vector<string> dirs;
+    vector<int> order;
+    vector<string> files;
+    BadCardPolicy policy = REJECT_BAD_CARDS;
+    for (int i = 1; i < argv; i++) {
+        string arg = argc[i];
+        if (arg == "--names" && i + 1 < argv) {
+            names = splitList(argc[++i]);
+        } else if (arg == "--dirs" && i + 1 < argv) {
+            dirs = splitList(argc[++i]);
+        } else if (arg == "--order" && i + 1 < argv) {
+            for (const string& index : splitList(argc[++i])) {
+                int p;
+                if (!parseIndex(index, p)) {
+                    cout << "--order must list player numbers, e.g. 0,2,1" << endl;
+                    return 1;
+                }
+                order.push_back(p);
+            }
+        } else if (arg.rfind("--on-error=", 0) == 0) {
+            if (!parseBadCardPolicy(arg.substr(11), policy)) {
+                cout << "--on-error must be reject or skip" << endl;
+                return 1;
+            }
+        } else {
+            files.push_back(arg);
+        }
+    }
+
+    if (files.size() < 2 || files.size() > size_t(Tournament::MAX_PLAYERS)) {
+        cout << "Please provide 2 to " << Tournament::MAX_PLAYERS << " file names" << endl;
+        return 1;
+    }
+    for (int p : order) {
+        if (p < 0 || size_t(p) >= files.size()) {
+            cout << "Invalid player " << p << " in turn order" << endl;
+            return 1;
+        }
+    }
+
+    vector<TournamentPlayer> players(files.size());
+    for (size_t p = 0; p < files.size(); p++) {
+        if (p < names.size()) {
+            players[p].name = names[p];
+        } else if (p < 2) {
+            players[p].name = p == 0 ? "Alice" : "Bob";
+        } else {
+            players[p].name = "Player " + to_string(p + 1);
+        }
+
+        string dir = p < dirs.size() ? dirs[p] : (p % 2 == 0 ? "asc" : "desc");
+        if (dir != "asc" && dir != "desc") {
+            cout << "Unknown direction " << dir << " (use asc or desc)" << endl;
+            return 1;
+        }
+        players[p].direction = dir == "asc" ? SCAN_ASCENDING : SCAN_DESCENDING;
+
+        if (!loadCards(files[p], players[p].hand, policy)) {
+            return 1;
+        }
+    }
+
+    Tournament tournament(players, order);
+    tournament.play(cout);
+
+    return 0;
+}
@@ -0,0 +1,282 @@
+// persistent_card_list.cpp
+// Author: Yusen Liu
+// Implementation of the classes defined in persistent_card_list.h
+
+#include "persistent_card_list.h"
+
+// ====== Helper Functions ======
+
+PersistentCardList::Node::Node(const Card& c, const Node* l, const Node* r)
+    : data(c), left(l), right(r), refs(1) {
+    int hl = l ? l->height : 0;
+    int hr = r ? r->height : 0;
+    height = 1 + (hl > hr ? hl : hr);
+}
+
+const PersistentCardList::Node* PersistentCardList::retain(const Node* node) {
+    if (node != nullptr) node->refs++;
+    return node;
+}
+
+// Drop one reference; free the node (and release its children) once nobody points at it
+void PersistentCardList::release(const Node* node) {
+    if (node == nullptr) return;
+    if (--node->refs > 0) return;
+    release(node->left);
+    release(node->right);
+    delete node;
+}
+
+int PersistentCardList::height(const Node* node) {
+    return node ? node->height : 0;
+}
+
+const PersistentCardList::Node* PersistentCardList::makeNode(const Card& card, const Node* left, const Node* right) {
+    return new Node(card, left, right);
+}
+
+// Build a node from adopted children, doing the AVL single/double rotation if the
+// heights differ by two. Rotated nodes are rebuilt rather than modified, so the
+// old versions that still point at them are untouched.
+const PersistentCardList::Node* PersistentCardList::balance(const Card& card, const Node* left, const Node* right) {
+    int hl = height(left);
+    int hr = height(right);
+
+    if (hl > hr + 1) {
+        const Node* result;
+        if (height(left->left) >= height(left->right)) {
+            // Single right rotation
+            result = makeNode(left->data, retain(left->left),
+                              makeNode(card, retain(left->right), right));
+        } else {
+            // Left-right double rotation
+            const Node* lr = left->right;
+            result = makeNode(lr->data,
+                              makeNode(left->data, retain(left->left), retain(lr->left)),
+                              makeNode(card, retain(lr->right), right));
+        }
+        release(left);
+        return result;
+    }
+
+    if (hr > hl + 1) {
+        const Node* result;
+        if (height(right->right) >= height(right->left)) {
+            // Single left rotation
+            result = makeNode(right->data,
+                              makeNode(card, left, retain(right->left)),
+                              retain(right->right));
+        } else {
+            // Right-left double rotation
+            const Node* rl = right->left;
+            result = makeNode(rl->data,
+                              makeNode(card, left, retain(rl->left)),
+                              makeNode(right->data, retain(rl->right), retain(right->right)));
+        }
+        release(right);
+        return result;
+    }
+
+    return makeNode(card, left, right);
+}
+
+// Insert a card, copying only the nodes on the search path
+const PersistentCardList::Node* PersistentCardList::insertHelper(const Node* node, const Card& card, bool& added) {
+    if (node == nullptr) {
+        added = true;
+        return makeNode(card, nullptr, nullptr);
+    }
+
+    if (card < node->data) {
+        return balance(node->data, insertHelper(node->left, card, added), retain(node->right));
+    } else if (card > node->data) {
+        return balance(node->data, retain(node->left), insertHelper(node->right, card, added));
+    }
+    // Already present: the new version is the same tree
+    added = false;
+    return retain(node);
+}
+
+// Remove the minimum of a non-empty subtree
+const PersistentCardList::Node* PersistentCardList::eraseMin(const Node* node) {
+    if (node->left == nullptr) return retain(node->right);
+    return balance(node->data, eraseMin(node->left), retain(node->right));
+}
+
+// Erase a card, copying only the nodes on the search path
+const PersistentCardList::Node* PersistentCardList::eraseHelper(const Node* node, const Card& card, bool& removed) {
+    if (node == nullptr) {
+        removed = false;
+        return nullptr;
+    }
+
+    if (card < node->data) {
+        return balance(node->data, eraseHelper(node->left, card, removed), retain(node->right));
+    } else if (card > node->data) {
+        return balance(node->data, retain(node->left), eraseHelper(node->right, card, removed));
+    }
+
+    // Found the node to delete
+    removed = true;
+    if (node->left == nullptr) return retain(node->right);
+    if (node->right == nullptr) return retain(node->left);
+
+    // Two children: replace with the inorder successor
+    const Node* successor = node->right;
+    while (successor->left != nullptr) {
+        successor = successor->left;
+    }
+    return balance(successor->data, retain(node->left), eraseMin(node->right));
+}
+
+const PersistentCardList::Node* PersistentCardList::findHelper(const Node* node, const Card& card) {
+    while (node != nullptr) {
+        if (card < node->data) {
+            node = node->left;
+        } else if (card > node->data) {
+            node = node->right;
+        } else {
+            return node;
+        }
+    }
+    return nullptr;
+}
+
+// ====== Iterator Methods ======
+
+PersistentCardList::Iterator::Iterator(const Node* root) {
+    for (const Node* node = root; node != nullptr; node = node->left) {
+        path.push_back(node);
+    }
+}
+
+PersistentCardList::Iterator& PersistentCardList::Iterator::operator++() {
+    if (path.empty()) return *this;
+
+    const Node* node = path.back();
+    path.pop_back();
+    // Successor is the minimum of the right subtree, or the nearest ancestor still on the stack
+    for (node = node->right; node != nullptr; node = node->left) {
+        path.push_back(node);
+    }
+    return *this;
+}
+
+const Card& PersistentCardList::Iterator::operator*() const {
+    return path.back()->data;
+}
+
+const Card* PersistentCardList::Iterator::operator->() const {
+    return &(path.back()->data);
+}
+
+bool PersistentCardList::Iterator::operator==(const Iterator& other) const {
+    if (path.empty() || other.path.empty()) return path.empty() && other.path.empty();
+    return path.back() == other.path.back();
+}
+
+bool PersistentCardList::Iterator::operator!=(const Iterator& other) const {
+    return !(*this == other);
+}
+
+// ====== ReverseIterator Methods ======
+
+PersistentCardList::ReverseIterator::ReverseIterator(const Node* root) {
+    for (const Node* node = root; node != nullptr; node = node->right) {
+        path.push_back(node);
+    }
+}
+
+PersistentCardList::ReverseIterator& PersistentCardList::ReverseIterator::operator++() {
+    if (path.empty()) return *this;
+
+    const Node* node = path.back();
+    path.pop_back();
+    // Predecessor is the maximum of the left subtree, or the nearest ancestor still on the stack
+    for (node = node->left; node != nullptr; node = node->right) {
+        path.push_back(node);
+    }
+    return *this;
+}
+
+const Card& PersistentCardList::ReverseIterator::operator*() const {
+    return path.back()->data;
+}
+
+const Card* PersistentCardList::ReverseIterator::operator->() const {
+    return &(path.back()->data);
+}
+
+bool PersistentCardList::ReverseIterator::operator==(const ReverseIterator& other) const {
+    if (path.empty() || other.path.empty()) return path.empty() && other.path.empty();
+    return path.back() == other.path.back();
+}
+
+bool PersistentCardList::ReverseIterator::operator!=(const ReverseIterator& other) const {
+    return !(*this == other);
+}
+
+// ====== PersistentCardList Methods ======
+
+PersistentCardList::PersistentCardList() : root(nullptr), size(0) {}
+
+PersistentCardList::PersistentCardList(const Node* r, size_t s) : root(r), size(s) {}
+
+PersistentCardList::PersistentCardList(const PersistentCardList& other)
+    : root(retain(other.root)), size(other.size) {}
+
+PersistentCardList& PersistentCardList::operator=(const PersistentCardList& other) {
+    // Retain first so self-assignment can't free the tree
+    const Node* newRoot = retain(other.root);
+    release(root);
+    root = newRoot;
+    size = other.size;
+    return *this;
+}
+
+PersistentCardList::~PersistentCardList() {
+    release(root);
+}
+
+PersistentCardList PersistentCardList::insert(const Card& card) const {
+    // No duplicates: skip the path copy entirely if the card is already there
+    if (contains(card)) return *this;
+    bool added = false;
+    const Node* newRoot = insertHelper(root, card, added);
+    return PersistentCardList(newRoot, added ? size + 1 : size);
+}
+
+PersistentCardList PersistentCardList::erase(const Card& card) const {
+    if (!contains(card)) return *this;
+    bool removed = false;
+    const Node* newRoot = eraseHelper(root, card, removed);
+    return PersistentCardList(newRoot, removed ? size - 1 : size);
+}
+
+bool PersistentCardList::contains(const Card& card) const {
+    return findHelper(root, card) != nullptr;
+}
+
+PersistentCardList::Iterator PersistentCardList::begin() const {
+    return Iterator(root);
+}
+
+PersistentCardList::Iterator PersistentCardList::end() const {
+    return Iterator();
+}
+
+PersistentCardList::ReverseIterator PersistentCardList::rbegin() const {
+    return ReverseIterator(root);
+}
+
+PersistentCardList::ReverseIterator PersistentCardList::rend() const {
+    return ReverseIterator();
+}
+
+bool PersistentCardList::empty() const {
+    return size == 0;
+}
+
+size_t PersistentCardList::getSize() const {
+    return size;
+}
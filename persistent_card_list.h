@@ -0,0 +1,112 @@
+// persistent_card_list.h
+// Author: Yusen Liu
+// Persistent (immutable) balanced BST of cards. insert/erase return a new version
+// that shares every untouched node with the old one (path copying), so taking a
+// snapshot of a hand is O(1) and each update is O(log n).
+
+#ifndef PERSISTENT_CARD_LIST_H
+#define PERSISTENT_CARD_LIST_H
+
+#include "card.h"
+#include <vector>
+
+class PersistentCardList {
+private:
+    // Nodes are never modified after construction, only shared. Each node counts
+    // how many parents/versions point at it and is deleted when that reaches zero.
+    // The count is not atomic: a version must only be copied or dropped by one thread at a time.
+    struct Node {
+        Card data;
+        const Node* left;
+        const Node* right;
+        int height;
+        mutable size_t refs;
+
+        Node(const Card& c, const Node* l, const Node* r);
+    };
+
+    const Node* root;
+    size_t size;
+
+    PersistentCardList(const Node* r, size_t s);
+
+    // Reference counting
+    static const Node* retain(const Node* node);
+    static void release(const Node* node);
+
+    // Helper functions for tree operations. Every helper returning a Node* hands
+    // back an owned reference; children passed to makeNode/balance are adopted.
+    static int height(const Node* node);
+    static const Node* makeNode(const Card& card, const Node* left, const Node* right);
+    static const Node* balance(const Card& card, const Node* left, const Node* right);
+    static const Node* insertHelper(const Node* node, const Card& card, bool& added);
+    static const Node* eraseHelper(const Node* node, const Card& card, bool& removed);
+    static const Node* eraseMin(const Node* node);
+    static const Node* findHelper(const Node* node, const Card& card);
+
+public:
+    // In-order iterator. Nodes have no parent pointers (they are shared between
+    // versions), so the iterator keeps the path from the root on a stack.
+    class Iterator {
+    private:
+        std::vector<const Node*> path;
+
+    public:
+        Iterator() {}
+        Iterator(const Node* root);
+
+        // Prefix increment (operator++)
+        Iterator& operator++();
+
+        // Dereference
+        const Card& operator*() const;
+        const Card* operator->() const;
+
+        // Equality/inequality
+        bool operator==(const Iterator& other) const;
+        bool operator!=(const Iterator& other) const;
+    };
+
+    class ReverseIterator {
+    private:
+        std::vector<const Node*> path;
+
+    public:
+        ReverseIterator() {}
+        ReverseIterator(const Node* root);
+
+        // Prefix increment (operator++) - goes to predecessor
+        ReverseIterator& operator++();
+
+        // Dereference
+        const Card& operator*() const;
+        const Card* operator->() const;
+
+        // Equality/inequality
+        bool operator==(const ReverseIterator& other) const;
+        bool operator!=(const ReverseIterator& other) const;
+    };
+
+    // Constructors/Destructors. Copying only bumps the root's reference count.
+    PersistentCardList();
+    PersistentCardList(const PersistentCardList& other);
+    PersistentCardList& operator=(const PersistentCardList& other);
+    ~PersistentCardList();
+
+    // Basic operations. The receiver is never modified.
+    PersistentCardList insert(const Card& card) const;
+    PersistentCardList erase(const Card& card) const;
+    bool contains(const Card& card) const;
+
+    // Iterator support
+    Iterator begin() const;
+    Iterator end() const;
+    ReverseIterator rbegin() const;
+    ReverseIterator rend() const;
+
+    // Utility
+    bool empty() const;
+    size_t getSize() const;
+};
+
+#endif
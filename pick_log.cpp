@@ -0,0 +1,149 @@
+// pick_log.cpp
+// Author: Yusen Liu
+// Implementation of the functions declared in pick_log.h
+
+#include "pick_log.h"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+// ====== Helper Functions ======
+
+static void putVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(uint8_t(value) | 0x80);
+        value >>= 7;
+    }
+    out.push_back(uint8_t(value));
+}
+
+// False if the varint runs past end or past 64 bits
+static bool getVarint(const uint8_t*& at, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && at < end; shift += 7) {
+        uint8_t byte = *at++;
+        value |= uint64_t(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+// A pick as the game prints it, or a note that the byte holds no card
+static std::string pickText(uint8_t byte) {
+    if ((byte & 0x3f) >= 52) return "card code " + std::to_string(byte & 0x3f);
+    Pick pick = decodePick(byte);
+    std::ostringstream out;
+    out << (pick.player == ALICE ? "Alice" : "Bob") << " picked matching card " << pick.card;
+    return out.str();
+}
+
+// ====== Encoding ======
+
+uint32_t handFingerprint(const CardCounts& counts) {
+    uint32_t hash = 2166136261u;
+    for (uint64_t copies : counts) {
+        for (int i = 0; i < 8; i++) {
+            hash = (hash ^ uint8_t(copies >> (8 * i))) * 16777619u;
+        }
+    }
+    return hash;
+}
+
+uint8_t encodePick(const Pick& pick) {
+    return uint8_t(pick.card.toCode()) | (pick.player == BOB ? PICK_BOB_BIT : 0);
+}
+
+Pick decodePick(uint8_t byte) {
+    return Pick{byte & PICK_BOB_BIT ? BOB : ALICE, Card::fromCode(byte & 0x3f)};
+}
+
+PickLog makePickLog(const CardCounts& alice, const CardCounts& bob, const std::vector<Pick>& picks) {
+    PickLog log;
+    for (int code = 0; code < 52; code++) {
+        log.aliceCards += alice[code];
+        log.bobCards += bob[code];
+    }
+    log.aliceFingerprint = handFingerprint(alice);
+    log.bobFingerprint = handFingerprint(bob);
+    log.picks.reserve(picks.size());
+    for (const Pick& pick : picks) {
+        log.picks.push_back(encodePick(pick));
+    }
+    return log;
+}
+
+// ====== Files ======
+
+bool writePickLog(const std::string& path, const PickLog& log) {
+    std::vector<uint8_t> out(4);
+    memcpy(out.data(), "PLOG", 4);
+    putVarint(out, PICK_LOG_VERSION);
+    putVarint(out, log.aliceCards);
+    putVarint(out, log.bobCards);
+    putVarint(out, log.aliceFingerprint);
+    putVarint(out, log.bobFingerprint);
+    putVarint(out, log.picks.size());
+    out.insert(out.end(), log.picks.begin(), log.picks.end());
+
+    std::ofstream file(path, std::ios::binary);
+    file.write((const char*)out.data(), out.size());
+    return bool(file);
+}
+
+bool readPickLog(const std::string& path, PickLog& log) {
+    std::ifstream file(path, std::ios::binary);
+    if (file.fail()) return false;
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (data.size() < 4 || memcmp(data.data(), "PLOG", 4) != 0) return false;
+
+    const uint8_t* at = data.data() + 4;
+    const uint8_t* end = data.data() + data.size();
+    uint64_t version, aliceFingerprint, bobFingerprint, picks;
+    if (!getVarint(at, end, version) || version != PICK_LOG_VERSION) return false;
+    if (!getVarint(at, end, log.aliceCards) || !getVarint(at, end, log.bobCards)) return false;
+    if (!getVarint(at, end, aliceFingerprint) || !getVarint(at, end, bobFingerprint)) return false;
+    if (!getVarint(at, end, picks) || uint64_t(end - at) != picks) return false;
+    log.aliceFingerprint = uint32_t(aliceFingerprint);
+    log.bobFingerprint = uint32_t(bobFingerprint);
+    log.picks.assign(at, end);
+    return true;
+}
+
+// ====== Replay ======
+
+bool replayPickLog(const PickLog& log, CardCounts& alice, CardCounts& bob, std::string& error) {
+    if (handFingerprint(alice) != log.aliceFingerprint || handFingerprint(bob) != log.bobFingerprint) {
+        error = "The hands are not the ones this log was recorded for";
+        return false;
+    }
+
+    // Bit c is set while both players hold card code c
+    uint64_t shared = 0;
+    for (int code = 0; code < 52; code++) {
+        if (alice[code] && bob[code]) shared |= uint64_t(1) << code;
+    }
+
+    // Picks alternate Alice, Bob, ... until nothing is shared: Alice takes the
+    // smallest shared card and Bob the largest
+    for (size_t i = 0; i < log.picks.size(); i++) {
+        uint8_t byte = log.picks[i];
+        bool bobTurn = i % 2 == 1;
+        int code = shared == 0 ? -1 : bobTurn ? 63 - __builtin_clzll(shared) : __builtin_ctzll(shared);
+        uint8_t expected = uint8_t(code | (bobTurn ? PICK_BOB_BIT : 0));
+        if (code < 0 || byte != expected) {
+            error = "Pick " + std::to_string(i + 1) + " is \"" + pickText(byte) + "\" but the game ";
+            error += code < 0 ? "has already ended" : "makes \"" + pickText(expected) + "\"";
+            return false;
+        }
+        alice[code]--;
+        bob[code]--;
+        if (alice[code] == 0 || bob[code] == 0) shared &= ~(uint64_t(1) << code);
+    }
+
+    if (shared != 0) {
+        error = "The log ends after " + std::to_string(log.picks.size()) + " picks but the game goes on";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,74 @@
+// pick_log.h
+// Author: Yusen Liu
+// Compact binary record of one game's picks, for auditing without keeping the
+// printed text, and a replay that checks a log against the starting hands.
+//
+// Layout:
+//   char[4]  magic "PLOG"
+//   varint   version (1)
+//   varint   Alice's card count, varint Bob's card count
+//   varint   Alice's fingerprint, varint Bob's fingerprint (see handFingerprint)
+//   varint   pick count
+//   then one byte per pick: bit 7 is the player (0 Alice, 1 Bob), bits 0-5 the
+//   card code (card.h), which orders cards the same way Card's operator< does
+// Varints are unsigned LEB128: 7 bits per byte, low bits first, high bit set on
+// every byte but the last.
+//
+// Replay needs no search: a 64-bit mask holds the cards both players still have,
+// Alice's pick must be its lowest bit and Bob's its highest, and each pick is a
+// couple of count updates, so a log checks at hundreds of millions of picks a second.
+
+#ifndef PICK_LOG_H
+#define PICK_LOG_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "card.h"
+#include "game.h"
+
+const uint32_t PICK_LOG_VERSION = 1;
+const uint8_t PICK_BOB_BIT = 0x80;
+
+// Copies of each card in a hand, by code
+using CardCounts = std::array<uint64_t, 52>;
+
+// Counts of any hand that iterates its cards
+template <class Hand>
+CardCounts countCards(const Hand& hand) {
+    CardCounts counts{};
+    for (const Card& card : hand) {
+        counts[card.toCode()]++;
+    }
+    return counts;
+}
+
+// FNV-1a over the count table: the same for any order the cards were read in
+uint32_t handFingerprint(const CardCounts& counts);
+
+struct PickLog {
+    uint64_t aliceCards = 0;
+    uint64_t bobCards = 0;
+    uint32_t aliceFingerprint = 0;
+    uint32_t bobFingerprint = 0;
+    std::vector<uint8_t> picks;
+};
+
+uint8_t encodePick(const Pick& pick);
+Pick decodePick(uint8_t byte);
+
+// Log for a game from its starting hands and the picks it made
+PickLog makePickLog(const CardCounts& alice, const CardCounts& bob, const std::vector<Pick>& picks);
+
+// File I/O. Reading fails on a bad magic, version or length.
+bool writePickLog(const std::string& path, const PickLog& log);
+bool readPickLog(const std::string& path, PickLog& log);
+
+// Check the log against the starting hands, leaving them as they end the game.
+// False with a description of the first problem in error if the hands are not
+// the ones the log was made for, a pick is not the one the game makes, or the
+// log stops before the game does.
+bool replayPickLog(const PickLog& log, CardCounts& alice, CardCounts& bob, std::string& error);
+
+#endif
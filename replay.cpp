@@ -0,0 +1,92 @@
+// replay.cpp
+// Author: Yusen Liu
+// Check a pick log (see pick_log.h) against the two starting hands, without
+// playing the game. With --print, also print the game's output rebuilt from the
+// log, exactly as game printed it. Hands are read the way game reads them, so
+// give the same --on-error policy the game was played with.
+// Usage: ./replay [--print] [--on-error=reject|skip] aliceFile bobFile game.plog
+
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "game_outcome.h"
+#include "hand_file.h"
+#include "pick_log.h"
+
+using namespace std;
+
+static bool loadCounts(const string& path, BadCardPolicy policy, CardCounts& counts) {
+    vector<Card> cards;
+    bool sorted = false;
+    if (!loadHandCards(path, policy, 1, cards, sorted, cerr)) return false;
+    counts = countCards(cards);
+    return true;
+}
+
+static vector<Card> cardsOf(const CardCounts& counts) {
+    vector<Card> cards;
+    for (int code = 0; code < 52; code++) {
+        cards.insert(cards.end(), counts[code], Card::fromCode(code));
+    }
+    return cards;
+}
+
+int main(int argv, char** argc) {
+    bool print = false;
+    BadCardPolicy policy = REJECT_BAD_CARDS;
+    vector<string> files;
+    for (int i = 1; i < argv; i++) {
+        string arg = argc[i];
+        if (arg == "--print") {
+            print = true;
+        } else if (arg.rfind("--on-error=", 0) == 0) {
+            if (!parseBadCardPolicy(arg.substr(11), policy)) {
+                cout << "--on-error must be reject or skip" << endl;
+                return 1;
+            }
+        } else {
+            files.push_back(arg);
+        }
+    }
+    if (files.size() != 3) {
+        cout << "Usage: replay [--print] [--on-error=reject|skip] aliceFile bobFile game.plog" << endl;
+        return 1;
+    }
+
+    CardCounts alice;
+    CardCounts bob;
+    for (int i = 0; i < 2; i++) {
+        if (!loadCounts(files[i], policy, i == 0 ? alice : bob)) {
+            cout << "Could not read hand file " << files[i] << endl;
+            return 1;
+        }
+    }
+    PickLog log;
+    if (!readPickLog(files[2], log)) {
+        cout << "Could not read pick log " << files[2] << endl;
+        return 1;
+    }
+
+    auto start = chrono::steady_clock::now();
+    string error;
+    bool ok = replayPickLog(log, alice, bob, error);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    if (!ok) {
+        cerr << files[2] << ": " << error << endl;
+        return 1;
+    }
+
+    if (print) {
+        for (uint8_t byte : log.picks) {
+            Pick pick = decodePick(byte);
+            cout << (pick.player == ALICE ? "Alice" : "Bob") << " picked matching card " << pick.card << endl;
+        }
+        printHands(cardsOf(alice), cardsOf(bob), cout);
+    } else {
+        cout << files[2] << ": " << log.picks.size() << " picks verified" << endl;
+    }
+    cerr << "Replayed in " << seconds * 1e3 << " ms (" << log.picks.size() / max(seconds, 1e-9) / 1e6
+         << " million picks/s)" << endl;
+    return 0;
+}
@@ -0,0 +1,49 @@
+// set_game.cpp
+// Author: Yusen Liu
+// Implementation of the game declared in set_game.h
+// Do not include card_list.h in this file
+
+#include "set_game.h"
+#include "game_outcome.h"
+#include "trace.h"
+
+void playSetGame(std::multiset<Card>& alice, std::multiset<Card>& bob, std::ostream& out) {
+  // Play the game: alternate Alice (forward) then Bob (reverse)
+  TRACE_SCOPE("match loop");
+  while (true) {
+    bool picked = false;
+
+    // Alice's turn: iterate from smallest to largest
+    //why I used auto? because it is clean and it is easier to read, and it is more efficient than using set<Card>::iterator
+    ////'it' is a forward iterator, aka a pointer
+    for (auto it = alice.begin(); it != alice.end(); ++it) {
+      // Check if Bob has a matching card and it is not at the end of the set (to avoid erasing while iterating)
+      if (bob.find(*it) != bob.end()) {
+        out << "Alice picked matching card " << *it << std::endl;
+        Card match = *it;
+        alice.erase(it);
+        // erase by key would drop every copy; remove just one
+        bob.erase(bob.find(match));
+        picked = true;
+        break;
+      }
+    }
+
+    // Bob's turn: iterate from largest to smallest (always runs after Alice)
+    //rit is the reverse iterator, which is also a pointer
+    for (auto rit = bob.rbegin(); rit != bob.rend(); ++rit) {
+      if (alice.find(*rit) != alice.end()) {
+        out << "Bob picked matching card " << *rit << std::endl;
+        Card match = *rit;
+        bob.erase(bob.find(match));
+        alice.erase(alice.find(match));
+        picked = true;
+        break;
+      }
+    }
+
+    if (!picked) break; // no more matches
+  }
+
+  printHands(alice, bob, out);
+}
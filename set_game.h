@@ -0,0 +1,17 @@
+// set_game.h
+// Author: Yusen Liu
+// The card matching game played on two std::multiset hands (the game_set engine).
+// A multiset holds every copy of a card from a multi-deck shoe.
+
+#ifndef SET_GAME_H
+#define SET_GAME_H
+
+#include <iostream>
+#include <set>
+#include "card.h"
+
+// Same rules and output as playGame in game.h, using std::multiset instead of CardList.
+// Each match removes one copy from each hand.
+void playSetGame(std::multiset<Card>& alice, std::multiset<Card>& bob, std::ostream& out);
+
+#endif
@@ -0,0 +1,128 @@
+// snapshot_card_list.cpp
+// Author: Yusen Liu
+// Implementation of the classes defined in snapshot_card_list.h
+
+#include "snapshot_card_list.h"
+
+// Reclaim once this many versions have been retired, so the writer pays a small
+// amortized cost per update instead of scanning reader slots every time
+static const size_t RECLAIM_BATCH = 32;
+
+// ====== Snapshot Methods ======
+
+SnapshotCardList::Snapshot::Snapshot(Snapshot&& other) : version(other.version), slot(other.slot) {
+    other.slot = nullptr;
+}
+
+SnapshotCardList::Snapshot::~Snapshot() {
+    // Unpin: the writer may now free any version retired after we pinned
+    if (slot != nullptr) slot->store(IDLE);
+}
+
+bool SnapshotCardList::Snapshot::contains(const Card& card) const {
+    return version->contains(card);
+}
+
+PersistentCardList::Iterator SnapshotCardList::Snapshot::begin() const {
+    return version->begin();
+}
+
+PersistentCardList::Iterator SnapshotCardList::Snapshot::end() const {
+    return version->end();
+}
+
+PersistentCardList::ReverseIterator SnapshotCardList::Snapshot::rbegin() const {
+    return version->rbegin();
+}
+
+PersistentCardList::ReverseIterator SnapshotCardList::Snapshot::rend() const {
+    return version->rend();
+}
+
+bool SnapshotCardList::Snapshot::empty() const {
+    return version->empty();
+}
+
+size_t SnapshotCardList::Snapshot::getSize() const {
+    return version->getSize();
+}
+
+// ====== SnapshotCardList Methods ======
+
+SnapshotCardList::SnapshotCardList() : current(new PersistentCardList()), globalEpoch(0) {}
+
+SnapshotCardList::~SnapshotCardList() {
+    for (const Retired& r : retired) {
+        delete r.version;
+    }
+    delete current.load();
+}
+
+// Swap in a new version and retire the old one under the epoch it was replaced in.
+// A reader that can still see the old version announced an epoch no later than that
+// tag (it announces before loading current), so waiting until every active reader
+// is past the tag is enough.
+void SnapshotCardList::publish(const PersistentCardList& next) {
+    const PersistentCardList* old = current.exchange(new PersistentCardList(next));
+    retired.push_back({globalEpoch.fetch_add(1), old});
+    if (retired.size() >= RECLAIM_BATCH) reclaim();
+}
+
+void SnapshotCardList::insert(const Card& card) {
+    const PersistentCardList* version = current.load();
+    if (version->contains(card)) return;
+    publish(version->insert(card));
+}
+
+void SnapshotCardList::erase(const Card& card) {
+    const PersistentCardList* version = current.load();
+    if (!version->contains(card)) return;
+    publish(version->erase(card));
+}
+
+bool SnapshotCardList::contains(const Card& card) const {
+    return current.load()->contains(card);
+}
+
+size_t SnapshotCardList::getSize() const {
+    return current.load()->getSize();
+}
+
+void SnapshotCardList::reclaim() {
+    uint64_t oldestActive = IDLE;
+    for (int i = 0; i < MAX_READERS; i++) {
+        uint64_t e = readers[i].epoch.load();
+        if (e < oldestActive) oldestActive = e;
+    }
+
+    // Only the writer touches node reference counts, so dropping versions here is safe
+    while (!retired.empty() && retired.front().epoch < oldestActive) {
+        delete retired.front().version;
+        retired.pop_front();
+    }
+}
+
+size_t SnapshotCardList::retiredCount() const {
+    return retired.size();
+}
+
+int SnapshotCardList::registerReader() {
+    for (int i = 0; i < MAX_READERS; i++) {
+        bool expected = false;
+        if (readers[i].used.compare_exchange_strong(expected, true)) return i;
+    }
+    return -1;
+}
+
+void SnapshotCardList::unregisterReader(int id) {
+    readers[id].epoch.store(IDLE);
+    readers[id].used.store(false);
+}
+
+SnapshotCardList::Snapshot SnapshotCardList::read(int id) {
+    // Announce the epoch before loading the version (both seq_cst), so the
+    // writer's scan either sees us or we see its newer version
+    readers[id].epoch.store(globalEpoch.load());
+    const PersistentCardList* version = current.load();
+    return Snapshot(version, &readers[id].epoch);
+}
@@ -0,0 +1,93 @@
+// snapshot_card_list.h
+// Author: Yusen Liu
+// Single-writer, many-reader hand. The writer publishes a new PersistentCardList
+// version per update (sharing unchanged nodes with the previous one); readers pin
+// the current version without locks and iterate a consistent snapshot of it.
+// Old versions are reclaimed with epoch-based reclamation, so a node is never
+// freed while a reader that could still see it is active.
+
+#ifndef SNAPSHOT_CARD_LIST_H
+#define SNAPSHOT_CARD_LIST_H
+
+#include "persistent_card_list.h"
+#include <atomic>
+#include <cstdint>
+#include <deque>
+
+class SnapshotCardList {
+public:
+    static constexpr int MAX_READERS = 64;
+
+private:
+    static constexpr uint64_t IDLE = UINT64_MAX;
+
+    // One slot per registered reader, padded so readers don't share cache lines.
+    // epoch is the global epoch the reader saw when it pinned a version, or IDLE.
+    struct alignas(64) ReaderSlot {
+        std::atomic<uint64_t> epoch;
+        std::atomic<bool> used;
+
+        ReaderSlot() : epoch(IDLE), used(false) {}
+    };
+
+    // A version that is no longer current, tagged with the epoch it was replaced in
+    struct Retired {
+        uint64_t epoch;
+        const PersistentCardList* version;
+    };
+
+    std::atomic<const PersistentCardList*> current;
+    std::atomic<uint64_t> globalEpoch;
+    ReaderSlot readers[MAX_READERS];
+    std::deque<Retired> retired;   // writer only, oldest first
+
+    void publish(const PersistentCardList& next);
+
+public:
+    // RAII read guard: pins one version for as long as it lives. Only the reader
+    // that owns the slot may use it, and it must not be held across another read().
+    class Snapshot {
+    private:
+        const PersistentCardList* version;
+        std::atomic<uint64_t>* slot;
+
+    public:
+        Snapshot(const PersistentCardList* v, std::atomic<uint64_t>* s) : version(v), slot(s) {}
+        Snapshot(Snapshot&& other);
+        Snapshot(const Snapshot&) = delete;
+        Snapshot& operator=(const Snapshot&) = delete;
+        ~Snapshot();
+
+        bool contains(const Card& card) const;
+        PersistentCardList::Iterator begin() const;
+        PersistentCardList::Iterator end() const;
+        PersistentCardList::ReverseIterator rbegin() const;
+        PersistentCardList::ReverseIterator rend() const;
+        bool empty() const;
+        size_t getSize() const;
+    };
+
+    // Constructors/Destructors. Destroying the list requires that no reader is active.
+    SnapshotCardList();
+    SnapshotCardList(const SnapshotCardList&) = delete;
+    SnapshotCardList& operator=(const SnapshotCardList&) = delete;
+    ~SnapshotCardList();
+
+    // Writer operations (one writer thread only)
+    void insert(const Card& card);
+    void erase(const Card& card);
+    bool contains(const Card& card) const;
+    size_t getSize() const;
+
+    // Free every retired version that no active reader can still see.
+    // Called automatically every few updates; cost is bounded by the number retired.
+    void reclaim();
+    size_t retiredCount() const;
+
+    // Reader operations. Each reader thread claims its own slot id once.
+    int registerReader();
+    void unregisterReader(int id);
+    Snapshot read(int id);
+};
+
+#endif
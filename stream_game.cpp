@@ -0,0 +1,183 @@
+// stream_game.cpp
+// Author: Yusen Liu
+// Implementation of the functions declared in stream_game.h
+
+#include "stream_game.h"
+#include "bounded_queue.h"
+#include "card_list.h"
+#include "game.h"
+#include "game_outcome.h"
+#include "hand_file.h"
+#include "hand_parser.h"
+#include "trace.h"
+#include <atomic>
+#include <sstream>
+#include <thread>
+
+// Queue capacity between stages, and how many games may be in flight at once
+// (read but not yet written). The window bounds the writer's reorder buffer.
+static const size_t QUEUE_CAPACITY = 256;
+static const size_t WINDOW = 1024;
+
+// A finished game waiting for the writer
+struct GameResult {
+    size_t seq;
+    uint64_t inputEnd;
+    std::string output;
+};
+
+// Parse the text of one hand, falling back to the validating reader for anything
+// the bulk parser rejects. Bad cards are dropped with the rest of their line and
+// appended to errors under name.
+static void parseHand(const std::string& text, const std::string& name, std::vector<Card>& hand,
+                      std::vector<CardReadError>& errors) {
+    std::vector<uint8_t> codes(maxCardsInText(text.size()));
+    HandParseResult result = parseHandText(text.data(), text.size(), codes.data(), codes.size());
+    hand.clear();
+    if (result.ok) {
+        for (size_t i = 0; i < result.cards; i++) {
+            hand.push_back(Card::fromCode(codes[i]));
+        }
+        return;
+    }
+
+    std::istringstream in(text);
+    readTextCards(in, name, SKIP_BAD_CARDS, hand, errors);
+}
+
+bool readGameRecord(std::istream& in, GameRecord& record) {
+    TRACE_SCOPE("read record");
+    std::string hands[2];
+    int current = 0;
+    bool any = false;
+    std::string line;
+    record.bytes = 0;
+
+    while (std::getline(in, line)) {
+        // The newline is consumed too, unless the input ended without one
+        record.bytes += line.size() + (in.eof() ? 0 : 1);
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line == "--") {
+            current = 1;
+            any = true;
+        } else if (line == "==") {
+            any = true;
+            break;
+        } else if (!line.empty()) {
+            hands[current] += line;
+            hands[current] += '\n';
+            any = true;
+        }
+    }
+    if (!any) return false;
+
+    record.errors.clear();
+    parseHand(hands[0], "Alice's hand", record.alice, record.errors);
+    parseHand(hands[1], "Bob's hand", record.bob, record.errors);
+    return true;
+}
+
+std::string playGameRecord(const GameRecord& record, bool fast) {
+    TRACE_SCOPE("play record");
+    CardList alice;
+    CardList bob;
+    for (const Card& c : record.alice) {
+        alice.insert(c);
+    }
+    for (const Card& c : record.bob) {
+        bob.insert(c);
+    }
+
+    std::ostringstream out;
+    if (fast) {
+        playFast(alice, bob, out);
+    } else {
+        playGame(alice, bob, out);
+    }
+    out << "==" << std::endl;
+    return out.str();
+}
+
+bool runStream(std::istream& in, std::ostream& out, int threads, bool fast, StreamProgress start,
+               const std::function<void(const StreamProgress&)>& onWritten, BadCardPolicy policy,
+               std::ostream& errors) {
+    if (threads < 1) threads = 1;
+
+    BoundedQueue<GameRecord> records(QUEUE_CAPACITY);
+    BoundedQueue<GameResult> results(QUEUE_CAPACITY);
+    std::atomic<size_t> written(0);
+    std::atomic<int> activeWorkers(threads);
+    bool rejected = false;     // set by the parser before it closes records
+
+    // Stage 1: parse records in order, waiting while the window is full
+    std::thread parser([&]() {
+        traceThreadName("parser");
+        GameRecord record;
+        uint64_t offset = start.inputOffset;
+        for (size_t seq = 0; readGameRecord(in, record); seq++) {
+            for (size_t done; seq >= (done = written.load(std::memory_order_acquire)) + WINDOW;) {
+                written.wait(done, std::memory_order_acquire);
+            }
+            record.seq = seq;
+            for (CardReadError& error : record.errors) {
+                error.file = "game " + std::to_string(start.games + seq + 1) + ", " + error.file;
+                errors << formatCardError(error) << (policy == SKIP_BAD_CARDS ? " (skipped)" : "") << std::endl;
+            }
+            if (!record.errors.empty() && policy == REJECT_BAD_CARDS) {
+                rejected = true;
+                break;
+            }
+            offset += record.bytes;
+            record.inputEnd = offset;
+            records.push(std::move(record));
+        }
+        records.close();
+    });
+
+    // Stage 2: play games in any order
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            traceThreadName("worker " + std::to_string(t));
+            GameRecord record;
+            while (records.pop(record)) {
+                results.push(GameResult{record.seq, record.inputEnd, playGameRecord(record, fast)});
+            }
+            // The last worker out tells the writer nothing else is coming
+            if (activeWorkers.fetch_sub(1) == 1) results.close();
+        });
+    }
+
+    // Stage 3 (this thread): write results back in input order
+    std::vector<GameResult> pending(WINDOW);
+    std::vector<bool> ready(WINDOW, false);
+    size_t next = 0;
+    StreamProgress progress = start;
+    GameResult result;
+    while (results.pop(result)) {
+        size_t slot = result.seq % WINDOW;
+        pending[slot] = std::move(result);
+        ready[slot] = true;
+        while (ready[next % WINDOW]) {
+            TRACE_SCOPE("write result");
+            GameResult& done = pending[next % WINDOW];
+            out << done.output;
+            progress.inputOffset = done.inputEnd;
+            progress.outputOffset += done.output.size();
+            progress.games++;
+            ready[next % WINDOW] = false;
+            done.output.clear();
+            next++;
+            written.store(next, std::memory_order_release);
+            written.notify_all();
+            if (onWritten) onWritten(progress);
+        }
+    }
+    out.flush();
+
+    parser.join();
+    for (auto& w : workers) {
+        w.join();
+    }
+    return !rejected;
+}
@@ -0,0 +1,62 @@
+// stream_game.h
+// Author: Yusen Liu
+// Streaming mode for game: plays a long stream of concatenated games.
+//
+// Input is a sequence of records, each Alice's cards, a "--" line, Bob's cards
+// and a "==" line (the last "==" may be left off). The output of each game is
+// exactly what game prints for the same two hands, followed by a "==" line.
+//
+// Work runs as a three-stage pipeline: one parser thread, a pool of game workers
+// and one writer that restores input order. The stages are joined by bounded
+// lock-free queues, and the parser never runs more than a fixed window of games
+// ahead of the writer, so memory stays constant however long the stream is.
+
+#ifndef STREAM_GAME_H
+#define STREAM_GAME_H
+
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "card.h"
+#include "hand_file.h"
+
+// One game read from the stream
+struct GameRecord {
+    size_t seq;
+    size_t bytes;           // input consumed, separator lines included
+    uint64_t inputEnd;      // input offset just past this record
+    std::vector<Card> alice;
+    std::vector<Card> bob;
+    std::vector<CardReadError> errors;  // bad cards, already dropped from the hands;
+                                        // file is "Alice's hand" or "Bob's hand"
+};
+
+// How far a stream has got: everything before inputOffset has been played and
+// its results are the first outputOffset bytes of the output
+struct StreamProgress {
+    uint64_t inputOffset = 0;
+    uint64_t outputOffset = 0;
+    uint64_t games = 0;
+};
+
+// Read the next record. Returns false at end of input with nothing read. Bad
+// cards are dropped with the rest of their line and listed in record.errors.
+bool readGameRecord(std::istream& in, GameRecord& record);
+
+// Play one record the same way game does for two files
+std::string playGameRecord(const GameRecord& record, bool fast);
+
+// Run the pipeline; threads is the number of game workers. start says where in
+// the input and output this run begins (the input must already be positioned
+// there), and onWritten is called by the writer after each game's result is
+// written, with the progress that includes it.
+// Bad cards are reported on errors as "game N, Alice's hand:line: ...". With
+// skip the game is played without them; with reject the run stops before that
+// game (every earlier one is still written) and returns false.
+bool runStream(std::istream& in, std::ostream& out, int threads, bool fast, StreamProgress start = {},
+               const std::function<void(const StreamProgress&)>& onWritten = nullptr,
+               BadCardPolicy policy = SKIP_BAD_CARDS, std::ostream& errors = std::cerr);
+
+#endif
@@ -0,0 +1,252 @@
+// suited_card_list.cpp
+// Author: Yusen Liu
+// Implementation of the classes defined in suited_card_list.h
+
+#include "suited_card_list.h"
+#include <cstring>
+#include <ranges>
+
+static_assert(std::bidirectional_iterator<SuitedCardList::Iterator>);
+static_assert(std::bidirectional_iterator<SuitedCardList::ReverseIterator>);
+static_assert(std::ranges::bidirectional_range<SuitedCardList>);
+
+// ====== Helper Functions ======
+
+int SuitedCardList::nextCode(int from) const {
+    if (from < 0) from = 0;
+    for (int suit = from / 13; suit < 4; suit++) {
+        if (!((suits >> suit) & 1)) continue;   // nothing in this suit
+        unsigned mask = ranks[suit];
+        if (suit == from / 13) mask &= ~0u << (from % 13);
+        if (mask != 0) return suit * 13 + __builtin_ctz(mask);
+    }
+    return 52;
+}
+
+int SuitedCardList::prevCode(int from) const {
+    if (from > 51) from = 51;
+    for (int suit = from / 13; from >= 0 && suit >= 0; suit--) {
+        if (!((suits >> suit) & 1)) continue;
+        unsigned mask = ranks[suit];
+        if (suit == from / 13) mask &= (2u << (from % 13)) - 1;
+        if (mask != 0) return suit * 13 + 31 - __builtin_clz(mask);
+    }
+    return -1;
+}
+
+// ====== Iterator Methods ======
+
+SuitedCardList::Iterator& SuitedCardList::Iterator::operator++() {
+    if (code >= 52) return *this;
+    if (copy + 1 < list->counts[code / 13][code % 13]) {
+        copy++;
+    } else {
+        code = list->nextCode(code + 1);
+        copy = 0;
+    }
+    return *this;
+}
+
+SuitedCardList::Iterator SuitedCardList::Iterator::operator++(int) {
+    Iterator old = *this;
+    ++*this;
+    return old;
+}
+
+SuitedCardList::Iterator& SuitedCardList::Iterator::operator--() {
+    // end() steps back to the last copy of the largest card
+    if (copy > 0 && code < 52) {
+        copy--;
+    } else {
+        code = list->prevCode(code - 1);
+        copy = code >= 0 ? list->counts[code / 13][code % 13] - 1 : 0;
+    }
+    return *this;
+}
+
+SuitedCardList::Iterator SuitedCardList::Iterator::operator--(int) {
+    Iterator old = *this;
+    --*this;
+    return old;
+}
+
+const Card& SuitedCardList::Iterator::operator*() const {
+    return FULL_DECK[code];
+}
+
+const Card* SuitedCardList::Iterator::operator->() const {
+    return &FULL_DECK[code];
+}
+
+bool SuitedCardList::Iterator::operator==(const Iterator& other) const {
+    return code == other.code && copy == other.copy;
+}
+
+bool SuitedCardList::Iterator::operator!=(const Iterator& other) const {
+    return !(*this == other);
+}
+
+// ====== ReverseIterator Methods ======
+
+SuitedCardList::ReverseIterator& SuitedCardList::ReverseIterator::operator++() {
+    if (code < 0) return *this;
+    if (copy > 0) {
+        copy--;
+    } else {
+        code = list->prevCode(code - 1);
+        copy = code >= 0 ? list->counts[code / 13][code % 13] - 1 : 0;
+    }
+    return *this;
+}
+
+SuitedCardList::ReverseIterator SuitedCardList::ReverseIterator::operator++(int) {
+    ReverseIterator old = *this;
+    ++*this;
+    return old;
+}
+
+SuitedCardList::ReverseIterator& SuitedCardList::ReverseIterator::operator--() {
+    // rend() steps back to the first copy of the smallest card
+    if (code >= 0 && copy + 1 < list->counts[code / 13][code % 13]) {
+        copy++;
+    } else {
+        code = list->nextCode(code + 1);
+        copy = 0;
+    }
+    return *this;
+}
+
+SuitedCardList::ReverseIterator SuitedCardList::ReverseIterator::operator--(int) {
+    ReverseIterator old = *this;
+    --*this;
+    return old;
+}
+
+const Card& SuitedCardList::ReverseIterator::operator*() const {
+    return FULL_DECK[code];
+}
+
+const Card* SuitedCardList::ReverseIterator::operator->() const {
+    return &FULL_DECK[code];
+}
+
+bool SuitedCardList::ReverseIterator::operator==(const ReverseIterator& other) const {
+    return code == other.code && copy == other.copy;
+}
+
+bool SuitedCardList::ReverseIterator::operator!=(const ReverseIterator& other) const {
+    return !(*this == other);
+}
+
+// ====== SuitedCardList Methods ======
+
+SuitedCardList::SuitedCardList() : ranks{0, 0, 0, 0}, suits(0), cardCount(0) {
+    memset(counts, 0, sizeof(counts));
+}
+
+void SuitedCardList::insert(const Card& card) {
+    int code = card.toCode();
+    if (code < 0) return;
+    int suit = code / 13;
+    int rank = code % 13;
+    counts[suit][rank]++;
+    ranks[suit] |= uint16_t(1u << rank);
+    suits |= uint8_t(1u << suit);
+    cardCount++;
+}
+
+SuitedCardList::Iterator SuitedCardList::find(const Card& card) const {
+    int code = card.toCode();
+    return contains(card) ? Iterator(this, code, 0) : end();
+}
+
+void SuitedCardList::erase(const Card& card) {
+    int code = card.toCode();
+    if (code < 0) return;
+    int suit = code / 13;
+    int rank = code % 13;
+    if (counts[suit][rank] == 0) return;
+
+    // Remove one copy; the rank bit goes only with the last one
+    if (--counts[suit][rank] == 0) {
+        ranks[suit] &= uint16_t(~(1u << rank));
+        if (ranks[suit] == 0) suits &= uint8_t(~(1u << suit));
+    }
+    cardCount--;
+}
+
+void SuitedCardList::erase(Iterator it) {
+    if (it.code >= 0 && it.code < 52) {
+        erase(*it);
+    }
+}
+
+bool SuitedCardList::contains(const Card& card) const {
+    int code = card.toCode();
+    return code >= 0 && ((ranks[code / 13] >> (code % 13)) & 1);
+}
+
+size_t SuitedCardList::count(const Card& card) const {
+    int code = card.toCode();
+    return code >= 0 ? counts[code / 13][code % 13] : 0;
+}
+
+SuitedCardList::Iterator SuitedCardList::firstShared(const SuitedCardList& other) const {
+    // Only suits both hands hold can have a match
+    for (unsigned both = suits & other.suits; both != 0; both &= both - 1) {
+        int suit = __builtin_ctz(both);
+        unsigned shared = ranks[suit] & other.ranks[suit];
+        if (shared != 0) return Iterator(this, suit * 13 + __builtin_ctz(shared), 0);
+    }
+    return end();
+}
+
+SuitedCardList::ReverseIterator SuitedCardList::lastShared(const SuitedCardList& other) const {
+    for (unsigned both = suits & other.suits; both != 0; both &= ~(1u << (31 - __builtin_clz(both)))) {
+        int suit = 31 - __builtin_clz(both);
+        unsigned shared = ranks[suit] & other.ranks[suit];
+        if (shared != 0) {
+            int code = suit * 13 + 31 - __builtin_clz(shared);
+            return ReverseIterator(this, code, counts[suit][code % 13] - 1);
+        }
+    }
+    return rend();
+}
+
+uint16_t SuitedCardList::suitRanks(char suit) const {
+    int s = Card::suitRank(suit);
+    return s >= 0 ? ranks[s] : 0;
+}
+
+uint8_t SuitedCardList::heldSuits() const {
+    return suits;
+}
+
+SuitedCardList::Iterator SuitedCardList::begin() const {
+    return Iterator(this, nextCode(0), 0);
+}
+
+SuitedCardList::Iterator SuitedCardList::end() const {
+    return Iterator(this, 52, 0);
+}
+
+SuitedCardList::ReverseIterator SuitedCardList::rbegin() const {
+    int code = prevCode(51);
+    return ReverseIterator(this, code, code >= 0 ? counts[code / 13][code % 13] - 1 : 0);
+}
+
+SuitedCardList::ReverseIterator SuitedCardList::rend() const {
+    return ReverseIterator(this, -1, 0);
+}
+
+bool SuitedCardList::empty() const {
+    return cardCount == 0;
+}
+
+size_t SuitedCardList::getSize() const {
+    return cardCount;
+}
+
+size_t SuitedCardList::size() const {
+    return cardCount;
+}
@@ -0,0 +1,134 @@
+// suited_card_list.h
+// Author: Yusen Liu
+// A hand partitioned by suit. Card order is suit-major (c < d < s < h), so a
+// hand is four independent runs; each suit keeps a 13-bit mask of the ranks
+// present plus a copy count per rank, and a 4-bit summary marks the suits that
+// hold anything. Scans skip empty suits outright, and the game's "first card we
+// both hold" search only looks at suits both players hold, one mask AND each.
+//
+// Same interface as CardList. Only standard deck cards can be stored; insert
+// ignores anything else.
+
+#ifndef SUITED_CARD_LIST_H
+#define SUITED_CARD_LIST_H
+
+#include "card.h"
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+class SuitedCardList {
+private:
+    uint16_t ranks[4];          // bit r - 1 set when rank r of the suit is held
+    uint32_t counts[4][13];     // copies held of each card
+    uint8_t suits;              // bit s set when ranks[s] != 0
+    size_t cardCount;
+
+    // First held code at or after from (52 if none), last at or before from (-1 if none)
+    int nextCode(int from) const;
+    int prevCode(int from) const;
+
+public:
+    // Iterators visit every copy of a card, like CardList's
+    class Iterator {
+    private:
+        const SuitedCardList* list;
+        int code;       // 52 at end
+        size_t copy;
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = Card;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Card*;
+        using reference = const Card&;
+
+        Iterator(const SuitedCardList* l = nullptr, int c = 52, size_t cp = 0) : list(l), code(c), copy(cp) {}
+
+        // Prefix/postfix increment (operator++)
+        Iterator& operator++();
+        Iterator operator++(int);
+
+        // Prefix/postfix decrement (operator--)
+        Iterator& operator--();
+        Iterator operator--(int);
+
+        // Dereference (cards live in FULL_DECK, so references stay valid)
+        const Card& operator*() const;
+        const Card* operator->() const;
+
+        // Equality/inequality
+        bool operator==(const Iterator& other) const;
+        bool operator!=(const Iterator& other) const;
+
+        friend class SuitedCardList;
+    };
+
+    class ReverseIterator {
+    private:
+        const SuitedCardList* list;
+        int code;       // -1 at end
+        size_t copy;
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = Card;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Card*;
+        using reference = const Card&;
+
+        ReverseIterator(const SuitedCardList* l = nullptr, int c = -1, size_t cp = 0) : list(l), code(c), copy(cp) {}
+
+        // Prefix/postfix increment (operator++) - goes to predecessor
+        ReverseIterator& operator++();
+        ReverseIterator operator++(int);
+
+        // Prefix/postfix decrement (operator--) - goes to successor
+        ReverseIterator& operator--();
+        ReverseIterator operator--(int);
+
+        // Dereference
+        const Card& operator*() const;
+        const Card* operator->() const;
+
+        // Equality/inequality
+        bool operator==(const ReverseIterator& other) const;
+        bool operator!=(const ReverseIterator& other) const;
+
+        friend class SuitedCardList;
+    };
+
+    // Constructors
+    SuitedCardList();
+
+    // Basic operations. insert adds one copy; erase removes one copy.
+    void insert(const Card& card);
+    Iterator find(const Card& card) const;
+    void erase(const Card& card);
+    void erase(Iterator it);
+    bool contains(const Card& card) const;
+    size_t count(const Card& card) const;
+
+    // Smallest card both hands hold (end() if none) and largest (rend() if none),
+    // looking only at suits both hands hold
+    Iterator firstShared(const SuitedCardList& other) const;
+    ReverseIterator lastShared(const SuitedCardList& other) const;
+
+    // Suit-restricted views: the 13-bit rank mask of a suit ('c', 'd', 's', 'h'),
+    // and the 4-bit mask of suits held (bit 0 = clubs)
+    uint16_t suitRanks(char suit) const;
+    uint8_t heldSuits() const;
+
+    // Iterator support
+    Iterator begin() const;
+    Iterator end() const;
+    ReverseIterator rbegin() const;
+    ReverseIterator rend() const;
+
+    // Utility
+    bool empty() const;
+    size_t getSize() const;
+    size_t size() const;
+};
+
+#endif
@@ -4,13 +4,112 @@
 
 #include <iostream>
 #include <sstream>
+#include <fstream>
 #include <cassert>
 #include <vector>
+#include <algorithm>
+#include <thread>
+#include <random>
+#include <atomic>
+#include <chrono>
+#include <set>
+#include <iterator>
+#include <ranges>
 #include "card.h"
 #include "card_list.h"
+#include "persistent_card_list.h"
+#include "concurrent_card_set.h"
+#include "snapshot_card_list.h"
+#include "game.h"
+#include "game_outcome.h"
+#include "hand_parser.h"
+#include "hand_file.h"
+#include "stream_game.h"
+#include "bounded_queue.h"
+#include "counted_card_set.h"
+#include "set_game.h"
+#include "tournament.h"
+#include "intersect.h"
+#include "hand_store.h"
+#include "checkpoint.h"
+#include "game_daemon.h"
+#include "pick_log.h"
+#include "suited_card_list.h"
+#include "trace.h"
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <sys/socket.h>
+#include <unistd.h>
 
 using namespace std;
 
+// ====== Allocation Counting ======
+// Every plain operator new/delete in this binary goes through these, so a test
+// can count what an operation allocates and frees and the bytes it keeps. Each
+// block carries its size in a 16-byte prefix, which keeps malloc's alignment;
+// the aligned forms are left to the library.
+
+static atomic<size_t> heapAllocations(0);
+static atomic<size_t> heapFrees(0);
+static atomic<size_t> heapBytes(0);
+static atomic<size_t> heapPeak(0);
+static const size_t HEAP_PREFIX = 16;
+
+static void* countedAlloc(size_t size) {
+    void* block = malloc(size + HEAP_PREFIX);
+    if (block == nullptr) return nullptr;
+    *(size_t*)block = size;
+    heapAllocations.fetch_add(1, memory_order_relaxed);
+    size_t now = heapBytes.fetch_add(size, memory_order_relaxed) + size;
+    size_t peak = heapPeak.load(memory_order_relaxed);
+    while (now > peak && !heapPeak.compare_exchange_weak(peak, now, memory_order_relaxed)) {}
+    return (char*)block + HEAP_PREFIX;
+}
+
+static void countedFree(void* p) {
+    if (p == nullptr) return;
+    char* block = (char*)p - HEAP_PREFIX;
+    heapFrees.fetch_add(1, memory_order_relaxed);
+    heapBytes.fetch_sub(*(size_t*)block, memory_order_relaxed);
+    free(block);
+}
+
+void* operator new(size_t size) {
+    void* p = countedAlloc(size);
+    if (p == nullptr) throw bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size) {
+    void* p = countedAlloc(size);
+    if (p == nullptr) throw bad_alloc();
+    return p;
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept { return countedAlloc(size); }
+void* operator new[](size_t size, const nothrow_t&) noexcept { return countedAlloc(size); }
+void operator delete(void* p) noexcept { countedFree(p); }
+void operator delete[](void* p) noexcept { countedFree(p); }
+void operator delete(void* p, size_t) noexcept { countedFree(p); }
+void operator delete[](void* p, size_t) noexcept { countedFree(p); }
+void operator delete(void* p, const nothrow_t&) noexcept { countedFree(p); }
+void operator delete[](void* p, const nothrow_t&) noexcept { countedFree(p); }
+
+// Heap activity since construction. Read the numbers before calling
+// assert_equal, whose test name is itself allocated.
+struct HeapScope {
+    size_t allocations0 = heapAllocations.load();
+    size_t frees0 = heapFrees.load();
+    size_t bytes0 = heapBytes.load();
+    
+    HeapScope() { heapPeak.store(bytes0); }
+    size_t allocations() const { return heapAllocations.load() - allocations0; }
+    size_t frees() const { return heapFrees.load() - frees0; }
+    long long liveBytes() const { return (long long)heapBytes.load() - (long long)bytes0; }
+    size_t peakBytes() const { return heapPeak.load() - bytes0; }
+};
+
 // ====== Helper function for testing ======
 void assert_equal(bool condition, const string& test_name) {
     if (condition) {
@@ -171,6 +270,48 @@ void test_card_io_operators() {
     assert_equal(ss5.str() == "d a", "Output operator handles ace correctly");
 }
 
+void test_validating_card_parse() {
+    cout << "\n=== Testing Validating Card Parse ===" << endl;
+    
+    // Test 1: parse() reports what is wrong and leaves the card alone
+    Card card = "s4"_card;
+    assert_equal(Card::parse("x", "3", card) == CARD_BAD_SUIT, "Bad suit");
+    assert_equal(Card::parse("h", "1o", card) == CARD_BAD_VALUE && card == "s4"_card, "Bad value leaves card unchanged");
+    assert_equal(Card::parse("h", "", card) == CARD_MISSING_VALUE, "Missing value");
+    
+    // Test 2: operator>> fails on a bad card instead of storing a half-parsed one
+    stringstream ss("h 5 d x c 2");
+    vector<Card> read;
+    Card c;
+    while (ss >> c) read.push_back(c);
+    assert_equal(read.size() == 1 && read[0] == "h5"_card && c == "h5"_card, "operator>> stops at bad card");
+    stringstream glued("h10");
+    assert_equal(bool(glued >> c) && c == "h10"_card, "operator>> reads suit and value without a space");
+    
+    // Test 3: Reject stops at the first bad card, with its line
+    string text = "h 5\nd x\nc 2\nq 3\ns\n";
+    vector<Card> cards;
+    vector<CardReadError> errors;
+    stringstream rejectIn(text);
+    assert_equal(!readTextCards(rejectIn, "hand.txt", REJECT_BAD_CARDS, cards, errors), "Reject fails the read");
+    assert_equal(errors.size() == 1 && errors[0].line == 2 && errors[0].error == CARD_BAD_VALUE, "Reject reports first bad card");
+    assert_equal(formatCardError(errors[0]) == "hand.txt:2: value must be a, 2-10, j, q or k 'd x'", "Error has file and line");
+    
+    // Test 4: Skip keeps the good cards and reports every bad one
+    cards.clear();
+    errors.clear();
+    stringstream skipIn(text);
+    assert_equal(readTextCards(skipIn, "hand.txt", SKIP_BAD_CARDS, cards, errors), "Skip succeeds");
+    assert_equal(cards == vector<Card>{"h5"_card, "c2"_card}, "Skip keeps good cards");
+    assert_equal(errors.size() == 3 && errors[1].line == 4 && errors[1].error == CARD_BAD_SUIT
+                 && errors[2].line == 5 && errors[2].error == CARD_MISSING_VALUE, "Skip reports every bad card");
+    
+    // Test 5: Policy flag values
+    BadCardPolicy policy = REJECT_BAD_CARDS;
+    assert_equal(parseBadCardPolicy("skip", policy) && policy == SKIP_BAD_CARDS && !parseBadCardPolicy("ignore", policy),
+                 "Policy names");
+}
+
 // ====== CardList (BST) Class Tests ======
 
 void test_cardlist_insert() {
@@ -518,6 +659,1668 @@ void test_cardlist_ordering() {
     assert_equal(allOrdered, "Elements in ascending order");
 }
 
+void test_cardlist_standard_iterators() {
+    cout << "\n=== Testing CardList with standard algorithms ===" << endl;
+    
+    CardList a, b;
+    for (const char* v : {"2", "5", "5", "9", "k"}) a.insert(Card('d', v));
+    for (const char* v : {"5", "5", "5", "9", "q"}) b.insert(Card('d', v));
+    
+    // Test 1: std::set_intersection sees every copy
+    vector<Card> shared;
+    set_intersection(a.begin(), a.end(), b.begin(), b.end(), back_inserter(shared));
+    assert_equal(shared == vector<Card>{Card('d', "5"), Card('d', "5"), Card('d', "9")}, "std::set_intersection on CardList");
+    
+    // Test 2: Ranges algorithms, size and distance
+    assert_equal(ranges::size(a) == 5 && ranges::distance(a) == 5, "ranges::size and ranges::distance");
+    assert_equal(ranges::count(b, Card('d', "5")) == 3, "ranges::count");
+    assert_equal(ranges::is_sorted(a), "ranges::is_sorted");
+    
+    // Test 3: Stepping back from end() and rend()
+    auto last = a.end();
+    --last;
+    assert_equal(*last == Card('d', "k"), "--end() is the largest card");
+    auto first = a.rend();
+    --first;
+    assert_equal(*first == Card('d', "2"), "--rend() is the smallest card");
+    
+    // Test 4: Postfix increment/decrement return the old position
+    auto it = a.begin();
+    assert_equal(*it++ == Card('d', "2") && *it == Card('d', "5"), "Postfix increment");
+    assert_equal(*it-- == Card('d', "5") && it == a.begin(), "Postfix decrement");
+    
+    // Test 5: views::reverse matches the hand-written reverse iterator
+    vector<Card> viaView, viaReverse;
+    for (const Card& c : a | views::reverse) viaView.push_back(c);
+    for (auto rit = a.rbegin(); rit != a.rend(); rit++) viaReverse.push_back(*rit);
+    assert_equal(viaView == viaReverse && viaView.size() == 5, "views::reverse on CardList");
+}
+
+void test_cardlist_split_join() {
+    cout << "\n=== Testing CardList balancing, split/join and set operations ===" << endl;
+    
+    // Test 1: Sorted inserts no longer build a linked list
+    CardList deck;
+    for (int code = 0; code < 52; code++) {
+        deck.insert(Card::fromCode(code));
+    }
+    assert_equal(deck.height() <= 7, "Sorted inserts stay AVL balanced");
+    for (int code = 0; code < 52; code += 2) {
+        deck.erase(Card::fromCode(code));
+    }
+    assert_equal(deck.height() <= 6 && deck.size() == 26, "Erases stay AVL balanced");
+    
+    // Test 2: Copies are deep
+    CardList copy(deck);
+    copy.erase(Card::fromCode(1));
+    assert_equal(deck.contains(Card::fromCode(1)) && !copy.contains(Card::fromCode(1)), "Copy is independent");
+    
+    // Test 3: split and join
+    CardList low;
+    for (int code = 0; code < 52; code++) {
+        low.insert(Card::fromCode(code));
+        low.insert(Card::fromCode(code));
+    }
+    CardList high = low.split(Card('s', "a"));
+    assert_equal(low.size() == 52 && high.size() == 52, "split divides the copies");
+    assert_equal(*low.rbegin() == Card('d', "k") && *high.begin() == Card('s', "a"), "split boundary");
+    assert_equal(!high.join(low), "join refuses overlapping lists");
+    assert_equal(low.join(high) && low.size() == 104 && high.empty(), "join appends");
+    assert_equal(ranges::is_sorted(low) && low.count(Card('s', "a")) == 2, "join keeps order and counts");
+    
+    // Test 4: Set operations give what the std algorithms give, sequential and parallel
+    mt19937 rng(39);
+    bool same = true;
+    for (int game = 0; game < 200 && same; game++) {
+        CardList a, b;
+        for (int i = 0, n = rng() % 150; i < n; i++) a.insert(Card::fromCode(rng() % 52));
+        for (int i = 0, n = rng() % 150; i < n; i++) b.insert(Card::fromCode(rng() % 52));
+        vector<Card> meet, join, diff;
+        set_intersection(a.begin(), a.end(), b.begin(), b.end(), back_inserter(meet));
+        set_union(a.begin(), a.end(), b.begin(), b.end(), back_inserter(join));
+        set_difference(a.begin(), a.end(), b.begin(), b.end(), back_inserter(diff));
+        for (int threads : {1, 4}) {
+            CardList m = CardList::setIntersection(a, b, threads, 1);
+            CardList u = CardList::setUnion(a, b, threads, 1);
+            CardList d = CardList::setDifference(a, b, threads, 1);
+            same = same && ranges::equal(m, meet) && m.size() == meet.size()
+                        && ranges::equal(u, join) && u.size() == join.size()
+                        && ranges::equal(d, diff) && d.size() == diff.size()
+                        && u.height() <= 7;
+        }
+    }
+    assert_equal(same, "Set operations match std::set_* algorithms");
+}
+
+void test_cardlist_bulk_erase() {
+    cout << "\n=== Testing CardList bulk erase ===" << endl;
+    
+    // Test 1: eraseIf removes a whole suit, every copy, and leaves a balanced tree
+    CardList list;
+    for (int code = 0; code < 52; code++) {
+        for (int copy = 0; copy <= code % 3; copy++) list.insert(Card::fromCode(code));
+    }
+    size_t before = list.size();
+    size_t hearts = list.eraseIf([](const Card& c) { return c.getSuit() == 'h'; });
+    bool noHearts = none_of(list.begin(), list.end(), [](const Card& c) { return c.getSuit() == 'h'; });
+    assert_equal(noHearts && list.size() == before - hearts && hearts > 13, "eraseIf removes all copies of a suit");
+    assert_equal(list.height() <= 6 && is_sorted(list.begin(), list.end()), "eraseIf leaves a balanced sorted tree");
+    assert_equal(erase_if(list, [](const Card&) { return false; }) == 0 && list.size() == before - hearts, "Erasing nothing changes nothing");
+    
+    // Test 2: erase(keys) matches std::set_difference, repeated and missing keys included
+    mt19937 rng(48);
+    bool allMatch = true;
+    for (int round = 0; round < 50; round++) {
+        vector<Card> cards, keys;
+        for (int i = 0; i < 200; i++) cards.push_back(Card::fromCode(rng() % 52));
+        for (int i = 0; i < int(rng() % 150); i++) keys.push_back(Card::fromCode(rng() % 52));
+        sort(cards.begin(), cards.end());
+        CardList hand;
+        hand.assignSorted(cards.data(), cards.size());
+        if (round % 2) sort(keys.begin(), keys.end());      // unsorted keys get sorted first
+        vector<Card> sortedKeys = keys, expected;
+        sort(sortedKeys.begin(), sortedKeys.end());
+        set_difference(cards.begin(), cards.end(), sortedKeys.begin(), sortedKeys.end(), back_inserter(expected));
+        size_t removed = hand.erase(keys.data(), keys.size());
+        allMatch = allMatch && removed == cards.size() - expected.size() && hand.size() == expected.size()
+                   && equal(hand.begin(), hand.end(), expected.begin(), expected.end());
+    }
+    assert_equal(allMatch, "erase(keys) matches std::set_difference");
+    
+    // Test 3: Removed nodes go to the spare list and the list still works
+    CardList small;
+    for (int code = 0; code < 10; code++) small.insert(Card::fromCode(code));
+    Card keys[] = {Card::fromCode(2), Card::fromCode(5), Card::fromCode(5), Card::fromCode(40)};
+    assert_equal(small.erase(keys, 4) == 2 && small.spareNodes() == 2, "Bulk erase recycles nodes");
+    small.insert(Card::fromCode(5));
+    assert_equal(small.contains(Card::fromCode(5)) && !small.contains(Card::fromCode(2)) && small.size() == 9, "Insert after bulk erase");
+}
+
+// ====== Memory Tests ======
+
+void test_cardlist_memory() {
+    cout << "\n=== Testing CardList memory ===" << endl;
+    
+    // Test 1: A new card allocates exactly one node, another copy of it nothing
+    CardList list;
+    size_t newCard, newCopy;
+    {
+        HeapScope heap;
+        list.insert(Card::fromCode(0));
+        newCard = heap.allocations();
+    }
+    {
+        HeapScope heap;
+        list.insert(Card::fromCode(0));
+        newCopy = heap.allocations();
+    }
+    assert_equal(newCard == 1, "New card allocates one node");
+    assert_equal(newCopy == 0, "Another copy allocates nothing");
+    
+    // Test 2: Erasing frees nothing and loses no node, through every erase path
+    // (leaf, one child, two children)
+    for (int code = 1; code < 31; code++) list.insert(Card::fromCode(code));
+    CardList::MemoryUsage before = list.memoryUsage();
+    size_t eraseAllocs, eraseFrees;
+    {
+        HeapScope heap;
+        for (int code = 1; code < 31; code += 2) list.erase(Card::fromCode(code));
+        eraseAllocs = heap.allocations();
+        eraseFrees = heap.frees();
+    }
+    CardList::MemoryUsage after = list.memoryUsage();
+    assert_equal(eraseAllocs == 0 && eraseFrees == 0, "Erase neither allocates nor frees");
+    assert_equal(after.nodes == before.nodes - 15 && after.spareNodes == before.spareNodes + 15, "Erased nodes all kept");
+    
+    // Test 3: Refilling uses the kept nodes; shrink frees exactly those
+    size_t refillAllocs, shrinkFrees;
+    {
+        HeapScope heap;
+        for (int code = 31; code < 46; code++) list.insert(Card::fromCode(code));
+        refillAllocs = heap.allocations();
+    }
+    list.erase(Card::fromCode(45));
+    list.erase(Card::fromCode(44));
+    {
+        HeapScope heap;
+        list.shrink();
+        shrinkFrees = heap.frees();
+    }
+    assert_equal(refillAllocs == 0, "Inserts after erase allocate nothing");
+    assert_equal(shrinkFrees == 2 && list.spareNodes() == 0, "Shrink frees the spare nodes");
+    
+    // Test 4: Copies allocate one node per distinct card and leave spares behind
+    list.erase(Card::fromCode(43));
+    size_t copyAllocs;
+    {
+        HeapScope heap;
+        CardList copy(list);
+        copyAllocs = heap.allocations();
+    }
+    assert_equal(copyAllocs == list.memoryUsage().nodes && list.memoryUsage().nodes == 28, "Copy allocates one node per card");
+    
+    // Test 5: Destruction frees every node it allocated, tree and spare
+    size_t builtAllocs, destroyFrees;
+    long long destroyLive;
+    {
+        HeapScope heap;
+        {
+            CardList temp;
+            for (int code = 0; code < 20; code++) temp.insert(Card::fromCode(code));
+            for (int code = 0; code < 5; code++) temp.erase(Card::fromCode(code));
+            builtAllocs = heap.allocations();
+        }
+        destroyFrees = heap.frees();
+        destroyLive = heap.liveBytes();
+    }
+    assert_equal(builtAllocs == 20 && destroyFrees == 20 && destroyLive == 0, "Destructor frees every node");
+    
+    // Test 6: Bytes per card, and inserts make no temporary allocations
+    long long deckLive;
+    size_t deckPeak;
+    CardList deck;
+    {
+        HeapScope heap;
+        for (int copy = 0; copy < 8; copy++) {
+            for (int code = 0; code < 52; code++) deck.insert(Card::fromCode(code));
+        }
+        deckLive = heap.liveBytes();
+        deckPeak = heap.peakBytes();
+    }
+    CardList::MemoryUsage usage = deck.memoryUsage();
+    assert_equal(deckLive == (long long)(52 * CardList::NODE_BYTES) && usage.bytes == sizeof(CardList) + deckLive,
+                 "Report matches the heap");
+    assert_equal(deckPeak == size_t(deckLive), "Peak is the final size");
+    assert_equal(CardList::NODE_BYTES <= 56, "Node is at most 56 bytes");
+    assert_equal(usage.bytesPerCard() <= 8 && usage.bytesPerCard() == double(usage.bytes) / 416,
+                 "Eight decks take at most 8 bytes per card");
+    assert_equal(usage.peakNodes == 52 && CardList().memoryUsage().bytesPerCard() == 0, "Peak and bytes per card reported");
+    
+    // Test 7: Bulk erase only allocates scratch space, and keeps every node
+    long long bulkLive;
+    {
+        HeapScope heap;
+        deck.eraseIf([](const Card& c) { return c.getSuit() == 's'; });
+        bulkLive = heap.liveBytes();
+    }
+    CardList::MemoryUsage bulk = deck.memoryUsage();
+    assert_equal(bulkLive == 0 && bulk.nodes == 39 && bulk.spareNodes == 13, "eraseIf keeps every node");
+    
+    // Test 8: The peak is a high-water mark: it stays after shrink and rises
+    // only when nodes are allocated, copied or joined in
+    deck.shrink();
+    CardList::MemoryUsage shrunk = deck.memoryUsage();
+    assert_equal(shrunk.nodes == 39 && shrunk.spareNodes == 0 && shrunk.peakNodes == 52, "Peak kept after shrink");
+    CardList copy(deck);
+    assert_equal(copy.memoryUsage().peakNodes == 39, "Copy counts its nodes");
+    CardList high = copy.split(Card::fromCode(26));
+    for (int code = 26; code < 39; code++) high.insert(Card::fromCode(code));     // the erased spades
+    CardList::MemoryUsage highUsage = high.memoryUsage();
+    assert_equal(highUsage.nodes == 26 && highUsage.peakNodes == 26, "Split half counts its nodes on the next insert");
+    copy.join(high);
+    assert_equal(copy.memoryUsage().nodes == 52 && copy.memoryUsage().peakNodes == 52, "Join adds the other list's nodes");
+    copy.clear();
+    copy.shrink();
+    for (int code = 0; code < 10; code++) copy.insert(Card::fromCode(code));
+    assert_equal(copy.memoryUsage().nodes == 10 && copy.memoryUsage().peakNodes == 52, "Refill below the peak keeps it");
+}
+
+void test_cardlist_node_pool() {
+    cout << "\n=== Testing CardList node reuse ===" << endl;
+    
+    // Test 1: clear() keeps the nodes, and refilling uses them up first
+    CardList list;
+    for (int code = 0; code < 20; code++) list.insert(Card::fromCode(code));
+    list.clear();
+    assert_equal(list.size() == 0 && list.begin() == list.end(), "Cleared list is empty");
+    assert_equal(list.spareNodes() == 20, "Cleared nodes kept");
+    for (int code = 0; code < 12; code++) list.insert(Card::fromCode(code));
+    assert_equal(list.spareNodes() == 8 && list.size() == 12, "Inserts reuse kept nodes");
+    
+    // Test 2: Erase and assignSorted recycle too
+    list.erase(Card::fromCode(3));
+    assert_equal(list.spareNodes() == 9 && !list.contains(Card::fromCode(3)), "Erased node kept");
+    vector<Card> sorted;
+    for (int code = 30; code < 35; code++) sorted.push_back(Card::fromCode(code));
+    list.assignSorted(sorted.data(), sorted.size());
+    assert_equal(list.spareNodes() == 15 && list.size() == 5 && list.contains(Card::fromCode(32)), "assignSorted reuses nodes");
+    
+    // Test 3: shrink() frees them
+    list.shrink();
+    assert_equal(list.spareNodes() == 0 && list.size() == 5, "Shrink frees spare nodes only");
+}
+
+// ====== PersistentCardList Tests ======
+
+void test_persistent_cardlist() {
+    cout << "\n=== Testing PersistentCardList ===" << endl;
+    
+    // Test 1: Insert returns a new version and leaves the old one alone
+    PersistentCardList v0;
+    PersistentCardList v1 = v0.insert(Card('h', "3"));
+    PersistentCardList v2 = v1.insert(Card('c', "a"));
+    assert_equal(v0.empty() && v1.getSize() == 1 && v2.getSize() == 2, "Insert creates new versions");
+    assert_equal(!v1.contains(Card('c', "a")) && v2.contains(Card('c', "a")), "Old version unchanged by insert");
+    
+    // Test 2: Erase returns a new version and leaves the old one alone
+    PersistentCardList v3 = v2.erase(Card('h', "3"));
+    assert_equal(v3.getSize() == 1 && !v3.contains(Card('h', "3")), "Erase removes card in new version");
+    assert_equal(v2.contains(Card('h', "3")), "Old version unchanged by erase");
+    
+    // Test 3: Duplicates and missing cards leave the size alone
+    assert_equal(v2.insert(Card('c', "a")).getSize() == 2, "Insert duplicate is a no-op");
+    assert_equal(v2.erase(Card('s', "9")).getSize() == 2, "Erase non-existent card is a no-op");
+    
+    // Test 4: Every snapshot of a long history iterates in order
+    vector<PersistentCardList> history;
+    PersistentCardList hand;
+    const char suits[] = {'h', 'c', 's', 'd'};
+    const string values[] = {"k", "a", "7", "10", "2", "q", "5", "j", "9", "3", "8", "4", "6"};
+    for (char s : suits) {
+        for (const string& v : values) {
+            hand = hand.insert(Card(s, v));
+            history.push_back(hand);
+        }
+    }
+    bool allOrdered = true;
+    for (size_t i = 0; i < history.size(); i++) {
+        size_t count = 0;
+        Card prev;
+        for (auto it = history[i].begin(); it != history[i].end(); ++it) {
+            if (count > 0 && !(prev < *it)) allOrdered = false;
+            prev = *it;
+            count++;
+        }
+        if (count != i + 1 || history[i].getSize() != i + 1) allOrdered = false;
+    }
+    assert_equal(allOrdered, "Every snapshot holds its own cards in order");
+    
+    // Test 5: Reverse iteration and erase down to empty
+    size_t revCount = 0;
+    Card prev;
+    bool revOrdered = true;
+    for (auto rit = hand.rbegin(); rit != hand.rend(); ++rit) {
+        if (revCount > 0 && !(*rit < prev)) revOrdered = false;
+        prev = *rit;
+        revCount++;
+    }
+    assert_equal(revOrdered && revCount == 52, "Reverse iteration is descending");
+    PersistentCardList drained = hand;
+    for (char s : suits) {
+        for (const string& v : values) {
+            drained = drained.erase(Card(s, v));
+        }
+    }
+    assert_equal(drained.empty() && hand.getSize() == 52, "Erase to empty keeps the full snapshot");
+}
+
+// ====== ConcurrentCardSet Tests ======
+
+void test_card_codes() {
+    cout << "\n=== Testing Card codes ===" << endl;
+    
+    // Test 1: Lowest and highest cards
+    assert_equal(Card('c', "a").toCode() == 0 && Card('h', "k").toCode() == 51, "Code range is 0..51");
+    
+    // Test 2: Codes round-trip
+    bool roundTrip = true;
+    for (int code = 0; code < 52; code++) {
+        if (Card::fromCode(code).toCode() != code) roundTrip = false;
+    }
+    assert_equal(roundTrip, "fromCode/toCode round-trip");
+    
+    // Test 3: Codes follow card ordering
+    bool ordered = true;
+    for (int code = 0; code + 1 < 52; code++) {
+        if (!(Card::fromCode(code) < Card::fromCode(code + 1))) ordered = false;
+    }
+    assert_equal(ordered, "Codes sort like cards");
+    
+    // Test 4: Non-deck cards have no code
+    assert_equal(Card('x', "3").toCode() == -1 && Card('h', "1").toCode() == -1, "Invalid cards map to -1");
+}
+
+void test_constexpr_cards() {
+    cout << "\n=== Testing compile-time cards ===" << endl;
+    
+    // Test 1: Literals, comparisons and codes are usable in constant expressions
+    constexpr Card tenOfHearts = "h10"_card;
+    static_assert(tenOfHearts.getSuit() == 'h' && tenOfHearts.getRank() == 10);
+    static_assert("sa"_card > "dk"_card && "c 2"_card.toCode() == 1);
+    assert_equal(tenOfHearts == Card('h', "10") && tenOfHearts.getValue() == "10", "Card literal matches runtime card");
+    
+    // Test 2: The compile-time deck is usable at run time
+    stringstream out;
+    out << FULL_DECK[0] << "," << FULL_DECK[9] << "," << FULL_DECK[51];
+    assert_equal(out.str() == "c a,c 10,h k", "FULL_DECK prints in card order");
+    
+    // Test 3: Reading a bad value gives a card outside the deck instead of throwing
+    stringstream in("d x h 11");
+    Card c1, c2;
+    in >> c1 >> c2;
+    assert_equal(c1.toCode() == -1 && c2.toCode() == -1 && c1.getValue() == "", "Non-card values have rank 0");
+}
+
+void test_concurrent_card_set() {
+    cout << "\n=== Testing ConcurrentCardSet ===" << endl;
+    
+    // Test 1: Single-threaded basics
+    ConcurrentCardSet set;
+    assert_equal(set.insert(Card('h', "3")) && !set.insert(Card('h', "3")), "Insert reports first insert only");
+    assert_equal(set.contains(Card('h', "3")) && set.getSize() == 1, "Contains after insert");
+    assert_equal(set.erase(Card('h', "3")) && !set.erase(Card('h', "3")), "Erase reports first erase only");
+    assert_equal(set.empty(), "Empty after erase");
+    
+    // Test 2: Ordered iteration both ways
+    set.insert(Card('h', "2"));
+    set.insert(Card('c', "3"));
+    set.insert(Card('d', "5"));
+    vector<Card> forward;
+    for (auto it = set.begin(); it != set.end(); ++it) forward.push_back(*it);
+    vector<Card> backward;
+    for (auto rit = set.rbegin(); rit != set.rend(); ++rit) backward.push_back(*rit);
+    assert_equal(forward.size() == 3 && forward[0] == Card('c', "3") && forward[2] == Card('h', "2"), "Forward iteration ascending");
+    assert_equal(backward.size() == 3 && backward[0] == Card('h', "2") && backward[2] == Card('c', "3"), "Reverse iteration descending");
+    
+    // Test 3: Concurrent dealing hands out every card exactly once
+    ConcurrentCardSet deck;
+    for (int code = 0; code < 52; code++) deck.insert(Card::fromCode(code));
+    const int threads = 4;
+    vector<vector<int>> dealt(threads);
+    vector<thread> dealers;
+    for (int t = 0; t < threads; t++) {
+        dealers.emplace_back([&, t]() {
+            for (int code = 0; code < 52; code++) {
+                if (deck.erase(Card::fromCode((code + t * 13) % 52))) dealt[t].push_back(code);
+            }
+        });
+    }
+    for (auto& d : dealers) d.join();
+    size_t total = 0;
+    for (auto& hand : dealt) total += hand.size();
+    assert_equal(total == 52 && deck.empty(), "Concurrent erase deals each card once");
+    
+    // Test 4: Stress - successful inserts minus erases match final membership
+    ConcurrentCardSet stress;
+    vector<vector<int>> net(threads, vector<int>(52, 0));
+    vector<thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            mt19937 rng(t + 7);
+            for (int i = 0; i < 200000; i++) {
+                int code = rng() % 52;
+                if (rng() & 1) {
+                    if (stress.insert(Card::fromCode(code))) net[t][code]++;
+                } else {
+                    if (stress.erase(Card::fromCode(code))) net[t][code]--;
+                }
+                stress.contains(Card::fromCode(code));
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+    bool consistent = true;
+    for (int code = 0; code < 52; code++) {
+        int sum = 0;
+        for (int t = 0; t < threads; t++) sum += net[t][code];
+        if (sum != (stress.contains(Card::fromCode(code)) ? 1 : 0)) consistent = false;
+    }
+    assert_equal(consistent, "Stress test: every card's history is linearizable");
+}
+
+// ====== SnapshotCardList Tests ======
+
+void test_snapshot_cardlist() {
+    cout << "\n=== Testing SnapshotCardList ===" << endl;
+    
+    // Test 1: Writer operations
+    SnapshotCardList hand;
+    hand.insert(Card('h', "3"));
+    hand.insert(Card('c', "a"));
+    hand.insert(Card('c', "a"));
+    hand.erase(Card('s', "9"));
+    assert_equal(hand.getSize() == 2 && hand.contains(Card('c', "a")), "Writer insert/erase");
+    
+    // Test 2: A snapshot does not see later writes
+    int id = hand.registerReader();
+    {
+        SnapshotCardList::Snapshot snap = hand.read(id);
+        hand.erase(Card('h', "3"));
+        hand.insert(Card('d', "5"));
+        assert_equal(snap.getSize() == 2 && snap.contains(Card('h', "3")) && !snap.contains(Card('d', "5")),
+                     "Snapshot is isolated from later writes");
+        
+        // Test 3: Pinned versions are not reclaimed
+        hand.reclaim();
+        assert_equal(hand.retiredCount() == 2, "Versions newer than a pinned reader are kept");
+    }
+    hand.reclaim();
+    assert_equal(hand.retiredCount() == 0, "Versions freed once the reader unpins");
+    hand.unregisterReader(id);
+    
+    // Test 4: Concurrent readers always see a consistent version. The writer only
+    // ever holds a contiguous run of codes, growing at the top and shrinking at the bottom.
+    SnapshotCardList shared;
+    atomic<bool> done(false);
+    atomic<bool> consistent(true);
+    vector<thread> readers;
+    for (int r = 0; r < 3; r++) {
+        readers.emplace_back([&]() {
+            int rid = shared.registerReader();
+            while (!done.load()) {
+                SnapshotCardList::Snapshot snap = shared.read(rid);
+                int prev = -1;
+                size_t count = 0;
+                for (auto it = snap.begin(); it != snap.end(); ++it) {
+                    int code = it->toCode();
+                    if (prev >= 0 && code != prev + 1) consistent = false;
+                    prev = code;
+                    count++;
+                }
+                if (count != snap.getSize()) consistent = false;
+            }
+            shared.unregisterReader(rid);
+        });
+    }
+    for (int round = 0; round < 200; round++) {
+        for (int code = 0; code < 52; code++) shared.insert(Card::fromCode(code));
+        for (int code = 0; code < 52; code++) shared.erase(Card::fromCode(code));
+    }
+    done = true;
+    for (auto& r : readers) r.join();
+    assert_equal(consistent.load(), "Concurrent readers only see whole versions");
+    
+    // Test 5: Reclaim after all readers leave frees everything retired
+    shared.reclaim();
+    assert_equal(shared.retiredCount() == 0 && shared.getSize() == 0, "All retired versions reclaimed");
+}
+
+// ====== Game Outcome Tests ======
+
+// Random hand: each card of the deck is included with the given percent chance
+static vector<Card> random_hand(mt19937& rng, int percent) {
+    vector<Card> hand;
+    for (int code = 0; code < 52; code++) {
+        if (int(rng() % 100) < percent) hand.push_back(Card::fromCode(code));
+    }
+    shuffle(hand.begin(), hand.end(), rng);
+    return hand;
+}
+
+void test_fast_outcome_matches_simulation() {
+    cout << "\n=== Testing --fast outcome against simulation ===" << endl;
+    
+    // Test 1: Known game
+    CardList a1, b1;
+    for (const char* v : {"3", "5", "9"}) a1.insert(Card('c', v));
+    for (const char* v : {"9", "3", "k"}) b1.insert(Card('c', v));
+    stringstream fast1;
+    playFast(a1, b1, fast1);
+    assert_equal(fast1.str() == "Alice picked matching card c 3\nBob picked matching card c 9\n"
+                 "\nAlice's cards:\nc 5\n\nBob's cards:\nc k\n", "Fast outcome of a known game");
+    
+    // Test 2: Fast mode leaves the hands untouched
+    assert_equal(a1.getSize() == 3 && b1.getSize() == 3, "Fast outcome does not modify hands");
+    
+    // Test 3: Empty and disjoint hands
+    CardList empty1, empty2, clubs;
+    clubs.insert(Card('c', "a"));
+    stringstream simEmpty, fastEmpty;
+    playFast(empty1, clubs, fastEmpty);
+    playGame(empty1, clubs, simEmpty);
+    assert_equal(simEmpty.str() == fastEmpty.str(), "Empty hand: fast matches simulation");
+    
+    // Test 4: Differential - random hands, CardList simulation vs fast on CardList and std::set
+    mt19937 rng(2024);
+    bool allMatch = true;
+    for (int game = 0; game < 500; game++) {
+        int pa = rng() % 101;
+        int pb = rng() % 101;
+        vector<Card> handA = random_hand(rng, pa);
+        vector<Card> handB = random_hand(rng, pb);
+        
+        CardList simA, simB, fastA, fastB;
+        set<Card> setA, setB;
+        for (const Card& c : handA) { simA.insert(c); fastA.insert(c); setA.insert(c); }
+        for (const Card& c : handB) { simB.insert(c); fastB.insert(c); setB.insert(c); }
+        
+        stringstream sim, fast, fastSet;
+        playGame(simA, simB, sim);
+        playFast(fastA, fastB, fast);
+        playFast(setA, setB, fastSet);
+        if (sim.str() != fast.str() || sim.str() != fastSet.str()) {
+            allMatch = false;
+            break;
+        }
+    }
+    assert_equal(allMatch, "Random games: fast output identical to simulation");
+}
+
+// ====== Hand Parser Tests ======
+
+void test_hand_parser() {
+    cout << "\n=== Testing hand parser ===" << endl;
+    
+    // Test 1: Simple hand
+    string text = "h 10\nc a\ns k\n";
+    uint8_t codes[8];
+    HandParseResult r1 = parseHandText(text.data(), text.size(), codes, 8);
+    assert_equal(r1.ok && r1.cards == 3 && codes[0] == Card('h', "10").toCode() &&
+                 codes[1] == Card('c', "a").toCode() && codes[2] == Card('s', "k").toCode(),
+                 "Parse simple hand");
+    
+    // Test 2: Malformed tokens are rejected with their offset
+    string bad = "h 3\nd x\n";
+    HandParseResult r2 = parseHandText(bad.data(), bad.size(), codes, 8);
+    assert_equal(!r2.ok && r2.cards == 1 && r2.errorOffset == 6, "Bad value reported at its offset");
+    string dangling = "h 3\nd";
+    assert_equal(!parseHandText(dangling.data(), dangling.size(), codes, 8).ok, "Suit without value rejected");
+    
+    // Test 3: Every kernel agrees with istream parsing on random text, including
+    // odd whitespace, CRLF and tokens straddling 32-byte blocks
+    mt19937 rng(99);
+    const char* gaps[] = {" ", "\n", "\r\n", "\t", "  ", " \n\n"};
+    bool agree = true;
+    for (int round = 0; round < 200 && agree; round++) {
+        string input;
+        vector<Card> expected;
+        int count = rng() % 100;
+        for (int i = 0; i < count; i++) {
+            Card c = Card::fromCode(rng() % 52);
+            expected.push_back(c);
+            input += string(1, c.getSuit()) + gaps[rng() % 6] + c.getValue() + gaps[rng() % 6];
+        }
+        if (rng() & 1) input.pop_back();   // sometimes no trailing delimiter
+        
+        vector<uint8_t> out(maxCardsInText(input.size()));
+        for (HandParserKernel kernel : {PARSER_SCALAR, PARSER_SSE2, PARSER_AVX2}) {
+            if (!handParserKernelSupported(kernel)) continue;
+            HandParseResult r = parseHandTextWith(kernel, input.data(), input.size(), out.data(), out.size());
+            if (!r.ok || r.cards != expected.size()) { agree = false; break; }
+            for (size_t i = 0; i < expected.size(); i++) {
+                if (Card::fromCode(out[i]) != expected[i]) agree = false;
+            }
+        }
+    }
+    assert_equal(agree, "All parser kernels match on random text");
+    
+    // Test 4: Capacity is respected
+    string many = "c 2 c 3 c 4";
+    HandParseResult r4 = parseHandText(many.data(), many.size(), codes, 2);
+    assert_equal(!r4.ok && r4.cards == 2, "Parser stops at capacity");
+}
+
+// ====== Binary Hand File Tests ======
+
+void test_binary_hand_files() {
+    cout << "\n=== Testing binary .hand files ===" << endl;
+    
+    // Test 1: Byte-code round trip (written sorted)
+    vector<uint8_t> codes = {51, 3, 17, 0, 3};
+    vector<uint8_t> loaded;
+    bool sorted = false;
+    assert_equal(writeBinaryHand("test_hand.hand", codes, false) && isBinaryHandFile("test_hand.hand"),
+                 "Write binary hand");
+    assert_equal(readHand("test_hand.hand", loaded, sorted) && sorted &&
+                 loaded == vector<uint8_t>({0, 3, 3, 17, 51}), "Read binary hand back sorted");
+    
+    // Test 2: Mask payload keeps multi-deck copies
+    assert_equal(writeBinaryHand("test_hand.hand", codes, true) && readHand("test_hand.hand", loaded, sorted) &&
+                 sorted && loaded == vector<uint8_t>({0, 3, 3, 17, 51}), "Mask payload round trip");
+    
+    // Test 2b: More than 255 copies of a card survive both payloads
+    vector<uint8_t> deep(300, 7);
+    deep.insert(deep.end(), 256, 51);
+    deep.push_back(0);
+    bool deepOk = true;
+    for (bool masks : {false, true}) {
+        deepOk = deepOk && writeBinaryHand("test_hand.hand", deep, masks) && readHand("test_hand.hand", loaded, sorted)
+                 && loaded.size() == deep.size() && count(loaded.begin(), loaded.end(), 7) == 300
+                 && count(loaded.begin(), loaded.end(), 51) == 256;
+    }
+    assert_equal(deepOk, "Over 255 copies round trip");
+    
+    // Test 3: Text files are detected and parsed
+    assert_equal(writeTextHand("test_hand.txt", codes) && !isBinaryHandFile("test_hand.txt") &&
+                 readHand("test_hand.txt", loaded, sorted) && !sorted && loaded == codes, "Text hand auto-detected");
+    
+    // Test 4: Corrupt binary is rejected
+    {
+        ofstream corrupt("test_hand.hand", ios::binary);
+        corrupt.write("HAND\x01\x01\x01\x00\x05\x00\x00\x00\x01", 13);
+    }
+    assert_equal(!readHand("test_hand.hand", loaded, sorted), "Truncated binary hand rejected");
+    
+    // Test 4b: A card count larger than the file is refused before allocating
+    size_t hugePeak[2];
+    bool hugeRefused = true;
+    const char* headers[2] = {"HAND\x01\x01\x00\x00\xff\xff\xff\xff\x01", "HAND\x01\x03\x01\x00\xff\xff\xff\xff"};
+    for (int i = 0; i < 2; i++) {
+        {
+            ofstream corrupt("test_hand.hand", ios::binary);
+            corrupt.write(headers[i], i == 0 ? 13 : 12);
+            if (i == 1) corrupt.write("\x01\x00\x00\x00\x00\x00\x00\x00", 8);     // one deck mask
+        }
+        HeapScope heap;
+        hugeRefused = hugeRefused && !readHand("test_hand.hand", loaded, sorted);
+        hugePeak[i] = heap.peakBytes();
+    }
+    assert_equal(hugeRefused && hugePeak[0] < (1 << 20) && hugePeak[1] < (1 << 20), "Huge card count refused without allocating");
+    remove("test_hand.hand");
+    remove("test_hand.txt");
+    
+    // Test 5: assignSorted builds a balanced, searchable tree
+    vector<Card> cards;
+    for (int code = 0; code < 52; code++) cards.push_back(Card::fromCode(code));
+    CardList list;
+    list.insert(Card('h', "k"));
+    list.assignSorted(cards.data(), cards.size());
+    bool inOrder = list.getSize() == 52;
+    int expected = 0;
+    for (auto it = list.begin(); it != list.end(); ++it) {
+        if (it->toCode() != expected++) inOrder = false;
+    }
+    for (auto rit = list.rbegin(); rit != list.rend(); ++rit) {
+        if (rit->toCode() != --expected) inOrder = false;
+    }
+    assert_equal(inOrder && list.contains(Card('d', "7")), "assignSorted builds ordered tree");
+    list.erase(Card('c', "a"));
+    list.erase(Card('s', "q"));
+    assert_equal(list.getSize() == 50 && !list.contains(Card('s', "q")), "Erase works on bulk-built tree");
+}
+
+void test_parallel_hand_loading() {
+    cout << "\n=== Testing parallel hand loading ===" << endl;
+    
+    // A multi-deck text hand big enough to split into several chunks
+    mt19937 rng(5);
+    vector<uint8_t> codes;
+    for (int i = 0; i < 20000; i++) codes.push_back(rng() % 52);
+    writeTextHand("test_hand.txt", codes);
+    vector<uint8_t> sortedCodes = codes;
+    sort(sortedCodes.begin(), sortedCodes.end());
+    
+    // Test 1: Chunked parse returns every card, merged into ascending order
+    vector<Card> cards;
+    bool sorted = false;
+    bool ok = readHandCardsParallel("test_hand.txt", cards, sorted, 4, 1000);
+    bool same = ok && sorted && cards.size() == sortedCodes.size();
+    for (size_t i = 0; same && i < cards.size(); i++) {
+        if (cards[i].toCode() != sortedCodes[i]) same = false;
+    }
+    assert_equal(same, "Chunked parse merges into one sorted run");
+    
+    // Test 2: Small files and single thread keep file order
+    assert_equal(readHandCardsParallel("test_hand.txt", cards, sorted, 1, 1000) && !sorted &&
+                 cards.size() == codes.size() && cards[0].toCode() == codes[0], "One thread parses sequentially");
+    
+    // Test 3: A card split across lines still parses (falls back to one chunk)
+    {
+        ofstream split("test_hand.txt");
+        for (int i = 0; i < 2000; i++) split << "h\n10\n";
+    }
+    assert_equal(readHandCardsParallel("test_hand.txt", cards, sorted, 4, 1000) && cards.size() == 2000,
+                 "Cards split across lines parse correctly");
+    remove("test_hand.txt");
+}
+
+// ====== Hand Store Tests ======
+
+void test_hand_store() {
+    cout << "\n=== Testing Hand Store ===" << endl;
+    
+    // Test 1: Every hand reads back in card order with its copies
+    mt19937 rng(45);
+    vector<string> names = {"alice", "bob", "empty"};
+    vector<vector<uint8_t>> hands(3);
+    for (int h = 0; h < 2; h++) {
+        for (int i = 0; i < 150; i++) hands[h].push_back(rng() % 52);
+    }
+    assert_equal(buildHandStore("test_hand.store", names, hands), "Build store");
+    HandStore store;
+    assert_equal(store.open("test_hand.store") && store.handCount() == 3, "Open store");
+    bool same = true;
+    for (size_t h = 0; h < 3; h++) {
+        HandView view;
+        CardList list;
+        for (uint8_t code : hands[h]) list.insert(Card::fromCode(code));
+        same = same && store.hand(h, view) && view.name() == names[h] && ranges::equal(view, list)
+               && view.size() == list.size() && equal(view.rbegin(), view.rend(), list.rbegin(), list.rend());
+    }
+    assert_equal(same, "Views match CardList forward and backward");
+    
+    // Test 2: Queries
+    HandView alice;
+    assert_equal(store.findHand("alice", alice) && !store.findHand("carol", alice), "Find hand by name");
+    store.findHand("alice", alice);
+    Card held = Card::fromCode(hands[0][0]);
+    assert_equal(alice.contains(held) && alice.count(held) == size_t(count(hands[0].begin(), hands[0].end(), hands[0][0])),
+                 "Contains and count");
+    assert_equal(*alice.find(held) == held && alice.find(Card('x', "3")) == alice.end(), "Find");
+    HandView empty;
+    assert_equal(store.hand(2, empty) && empty.empty() && empty.begin() == empty.end(), "Empty hand");
+    
+    // Test 3: Views play the fast game like CardLists
+    HandView bob;
+    store.findHand("bob", bob);
+    CardList listA, listB;
+    for (uint8_t code : hands[0]) listA.insert(Card::fromCode(code));
+    for (uint8_t code : hands[1]) listB.insert(Card::fromCode(code));
+    stringstream expected, actual;
+    playGame(listA, listB, expected);
+    playFast(alice, bob, actual);
+    assert_equal(expected.str() == actual.str(), "Fast game on views matches simulation");
+    
+    // Test 3b: Rebuilding the file leaves views of the open store intact
+    vector<vector<uint8_t>> smaller = {{0}};
+    assert_equal(buildHandStore("test_hand.store", {"solo"}, smaller), "Rebuild open store");
+    CardList stillA, stillB;
+    for (uint8_t code : hands[0]) stillA.insert(Card::fromCode(code));
+    for (uint8_t code : hands[1]) stillB.insert(Card::fromCode(code));
+    assert_equal(ranges::equal(alice, stillA) && ranges::equal(bob, stillB), "Old views survive rebuild");
+    HandStore rebuilt;
+    assert_equal(rebuilt.open("test_hand.store") && rebuilt.handCount() == 1, "New opens see rebuild");
+    rebuilt.close();
+    assert_equal(buildHandStore("test_hand.store", names, hands), "Restore store");
+    store.close();
+    
+    // Test 4: Corrupt stores are refused
+    {
+        fstream file("test_hand.store", ios::in | ios::out | ios::binary);
+        file.seekp(HAND_STORE_HEADER_SIZE + 20);
+        file.put(char(7));      // alice's card count no longer matches her counts
+    }
+    HandView view;
+    assert_equal(store.open("test_hand.store") && !store.hand(0, view) && store.hand(1, view), "Bad card count refused");
+    store.close();
+    {
+        ofstream file("test_hand.store", ios::binary);
+        file << "HANDSTOR";
+    }
+    assert_equal(!store.open("test_hand.store") && !store.isOpen(), "Truncated store refused");
+    remove("test_hand.store");
+}
+
+// ====== Streaming Pipeline Tests ======
+
+void test_bounded_queue() {
+    cout << "\n=== Testing BoundedQueue ===" << endl;
+    
+    // Test 1: FIFO and full/empty reporting
+    BoundedQueue<int> q(4);
+    int v = 0;
+    for (int i = 0; i < 4; i++) { int x = i; q.tryPush(x); }
+    int extra = 9;
+    assert_equal(!q.tryPush(extra), "Push fails when full");
+    bool fifo = true;
+    for (int i = 0; i < 4; i++) fifo = fifo && q.tryPop(v) && v == i;
+    assert_equal(fifo && !q.tryPop(v), "Pop is FIFO and fails when empty");
+    
+    // Test 2: Many producers and consumers deliver every item once
+    BoundedQueue<int> mq(8);
+    atomic<long> sum(0);
+    atomic<int> producers(3);
+    vector<thread> threads;
+    for (int p = 0; p < 3; p++) {
+        threads.emplace_back([&, p]() {
+            for (int i = 1; i <= 10000; i++) mq.push(i + p * 10000);
+            if (producers.fetch_sub(1) == 1) mq.close();
+        });
+    }
+    for (int c = 0; c < 2; c++) {
+        threads.emplace_back([&]() {
+            int item;
+            while (mq.pop(item)) sum += item;
+        });
+    }
+    for (auto& t : threads) t.join();
+    assert_equal(sum.load() == 30000L * 30001 / 2, "MPMC queue delivers every item exactly once");
+}
+
+void test_stream_mode() {
+    cout << "\n=== Testing --stream pipeline ===" << endl;
+    
+    // Build a stream of random games and the expected concatenated output
+    mt19937 rng(33);
+    string input;
+    string expected;
+    for (int game = 0; game < 300; game++) {
+        vector<Card> a = random_hand(rng, rng() % 101);
+        vector<Card> b = random_hand(rng, rng() % 101);
+        CardList listA, listB;
+        for (const Card& c : a) { listA.insert(c); input += string(1, c.getSuit()) + " " + c.getValue() + "\n"; }
+        input += "--\n";
+        for (const Card& c : b) { listB.insert(c); input += string(1, c.getSuit()) + " " + c.getValue() + "\n"; }
+        input += "==\n";
+        stringstream out;
+        playGame(listA, listB, out);
+        expected += out.str() + "==\n";
+    }
+    
+    // Test 1: Record parsing
+    stringstream one("c a\nh 3\n--\nh 3\n==\n");
+    GameRecord record;
+    assert_equal(readGameRecord(one, record) && record.alice.size() == 2 && record.bob.size() == 1 &&
+                 !readGameRecord(one, record), "Read one game record");
+    
+    // Test 2: Single worker matches sequential output
+    stringstream in1(input), out1;
+    runStream(in1, out1, 1, false);
+    assert_equal(out1.str() == expected, "Stream with 1 worker matches game output");
+    
+    // Test 3: Several workers keep input order
+    stringstream in4(input), out4;
+    runStream(in4, out4, 4, false);
+    assert_equal(out4.str() == expected, "Stream with 4 workers keeps order");
+    
+    // Test 4: Fast mode and a missing final delimiter
+    input.resize(input.size() - 3);
+    stringstream inFast(input), outFast;
+    runStream(inFast, outFast, 3, true);
+    assert_equal(outFast.str() == expected, "Fast stream matches, last == optional");
+    
+    // Test 5: Bad cards are reported with their game; skip plays without them
+    string bad = "h 3\n--\nh 3\n==\nh 3\nx 4\n--\nh 3\n==\nc 5\n--\nc 5\n==\n";
+    stringstream inSkip(bad), outSkip, errSkip;
+    bool skipped = runStream(inSkip, outSkip, 2, false, {}, nullptr, SKIP_BAD_CARDS, errSkip);
+    string skipOutput = outSkip.str();
+    assert_equal(skipped && errSkip.str().find("game 2, Alice's hand:2:") != string::npos
+                 && errSkip.str().find("(skipped)") != string::npos
+                 && count(skipOutput.begin(), skipOutput.end(), '=') == 6, "Skipped bad card is reported");
+    
+    // Test 6: Reject stops before the bad game, after writing the ones before it
+    stringstream inReject(bad), outReject, errReject;
+    bool played = runStream(inReject, outReject, 2, false, {}, nullptr, REJECT_BAD_CARDS, errReject);
+    string rejectOutput = outReject.str();
+    assert_equal(!played && errReject.str().find("game 2, Alice's hand:2:") != string::npos
+                 && count(rejectOutput.begin(), rejectOutput.end(), '=') == 2, "Rejected bad card stops the stream");
+}
+
+void test_stream_checkpoint() {
+    cout << "\n=== Testing stream checkpoint/resume ===" << endl;
+    
+    // A file of random games
+    mt19937 rng(46);
+    string input;
+    for (int game = 0; game < 200; game++) {
+        for (const Card& c : random_hand(rng, rng() % 60)) input += string(1, c.getSuit()) + " " + c.getValue() + "\n";
+        input += "--\n";
+        for (const Card& c : random_hand(rng, rng() % 60)) input += string(1, c.getSuit()) + " " + c.getValue() + "\n";
+        input += "==\n";
+    }
+    ofstream("test_hand.games", ios::binary) << input;
+    auto slurp = [](const string& path) {
+        ifstream file(path, ios::binary);
+        return string(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+    };
+    stringstream in(input), expected;
+    runStream(in, expected, 2, false);
+    
+    // Test 1: Checkpoint files round-trip and reject corruption
+    StreamProgress progress{1234, 5678, 9};
+    StreamProgress back;
+    assert_equal(writeCheckpoint("test_hand.ckpt", progress) && readCheckpoint("test_hand.ckpt", back)
+                 && back.inputOffset == 1234 && back.outputOffset == 5678 && back.games == 9, "Checkpoint round trip");
+    {
+        fstream file("test_hand.ckpt", ios::in | ios::out | ios::binary);
+        file.seekp(10);
+        file.put('x');
+    }
+    assert_equal(!readCheckpoint("test_hand.ckpt", back), "Corrupt checkpoint rejected");
+    
+    // Test 2: A full run with checkpoints gives the plain stream output
+    BatchOptions options;
+    options.input = "test_hand.games";
+    options.output = "test_hand.out";
+    options.checkpoint = "test_hand.ckpt";
+    options.checkpointEvery = 16;
+    options.threads = 3;
+    string error;
+    remove("test_hand.ckpt");
+    assert_equal(runBatch(options, error) && slurp("test_hand.out") == expected.str(), "Batch output matches stream");
+    assert_equal(readCheckpoint("test_hand.ckpt", back) && back.games == 200 && back.inputOffset == input.size(),
+                 "Final checkpoint covers the whole input");
+    
+    // Test 3: Resume after a "crash" at game 77 with half-written output after it
+    StreamProgress at77;
+    stringstream in2(input), out2;
+    runStream(in2, out2, 1, false, {}, [&](const StreamProgress& p) { if (p.games == 77) at77 = p; });
+    writeCheckpoint("test_hand.ckpt", at77);
+    ofstream("test_hand.out", ios::binary) << expected.str().substr(0, at77.outputOffset) << "Alice picked matc";
+    options.resume = true;
+    assert_equal(runBatch(options, error) && slurp("test_hand.out") == expected.str(), "Resume gives identical output");
+    
+    // Test 4: Resuming a finished run changes nothing
+    assert_equal(runBatch(options, error) && slurp("test_hand.out") == expected.str(), "Resume after finish is a no-op");
+    
+    // Test 5: A rejected bad card fails the batch with the checkpoint just before it
+    ofstream("test_hand.games", ios::binary) << "h 3\n--\nh 3\n==\nh 3\nx 4\n--\nh 3\n==\n";
+    remove("test_hand.ckpt");
+    options.resume = false;
+    options.checkpointEvery = 1;
+    stringstream silenced;
+    streambuf* old = cerr.rdbuf(silenced.rdbuf());
+    bool rejected = !runBatch(options, error);
+    cerr.rdbuf(old);
+    assert_equal(rejected && error.find("bad card") != string::npos && readCheckpoint("test_hand.ckpt", back)
+                 && back.games == 1 && back.inputOffset == 14, "Batch stops at a rejected card");
+    remove("test_hand.games");
+    remove("test_hand.out");
+    remove("test_hand.ckpt");
+}
+
+// ====== Multi-Deck Tests ======
+
+void test_multideck_cardlist() {
+    cout << "\n=== Testing multi-deck CardList ===" << endl;
+    
+    // Test 1: Copies are counted, not dropped
+    CardList list;
+    list.insert(Card('h', "3"));
+    list.insert(Card('h', "3"));
+    list.insert(Card('h', "3"));
+    list.insert(Card('c', "a"));
+    assert_equal(list.getSize() == 4 && list.count(Card('h', "3")) == 3, "Duplicate inserts are counted");
+    
+    // Test 2: Iteration visits every copy both ways
+    vector<Card> forward, backward;
+    for (auto it = list.begin(); it != list.end(); ++it) forward.push_back(*it);
+    for (auto rit = list.rbegin(); rit != list.rend(); ++rit) backward.push_back(*rit);
+    assert_equal(forward.size() == 4 && forward[0] == Card('c', "a") && forward[3] == Card('h', "3"),
+                 "Forward iteration repeats copies");
+    assert_equal(backward.size() == 4 && backward[0] == Card('h', "3") && backward[3] == Card('c', "a"),
+                 "Reverse iteration repeats copies");
+    
+    // Test 3: Erase removes one copy at a time
+    list.erase(Card('h', "3"));
+    assert_equal(list.count(Card('h', "3")) == 2 && list.getSize() == 3, "Erase removes one copy");
+    list.erase(list.find(Card('h', "3")));
+    list.erase(Card('h', "3"));
+    assert_equal(!list.contains(Card('h', "3")) && list.getSize() == 1, "Last copy removes the card");
+    
+    // Test 4: Two-child erase keeps the successor's count
+    CardList tree;
+    for (const char* v : {"5", "2", "8", "7", "9"}) tree.insert(Card('d', v));
+    tree.insert(Card('d', "7"));
+    tree.erase(Card('d', "5"));
+    assert_equal(tree.count(Card('d', "7")) == 2 && tree.getSize() == 5, "Counts survive two-child erase");
+    
+    // Test 5: Bulk build keeps counts
+    vector<Card> sortedCards = {Card('c', "2"), Card('c', "2"), Card('d', "k"), Card('h', "a"), Card('h', "a"), Card('h', "a")};
+    CardList bulk;
+    bulk.assignSorted(sortedCards.data(), sortedCards.size());
+    assert_equal(bulk.getSize() == 6 && bulk.count(Card('h', "a")) == 3 && bulk.count(Card('c', "2")) == 2,
+                 "assignSorted keeps copies");
+}
+
+void test_counted_card_set() {
+    cout << "\n=== Testing CountedCardSet ===" << endl;
+    
+    // Test 1: Counting copies
+    CountedCardSet shoe;
+    for (int i = 0; i < 8; i++) shoe.insert(Card('s', "q"));
+    shoe.insert(Card('c', "2"));
+    assert_equal(shoe.count(Card('s', "q")) == 8 && shoe.getSize() == 9, "Counts up to 8 decks");
+    
+    // Test 2: Counter limit and invalid cards
+    for (int i = 8; i < 15; i++) shoe.insert(Card('s', "q"));
+    assert_equal(!shoe.insert(Card('s', "q")) && !shoe.insert(Card('x', "q")), "Rejects overflow and non-deck cards");
+    
+    // Test 3: Erase one copy; neighbouring counters are untouched
+    shoe.erase(Card('s', "q"));
+    assert_equal(shoe.count(Card('s', "q")) == 14 && shoe.count(Card('s', "k")) == 0 && shoe.count(Card('c', "2")) == 1,
+                 "Erase removes one copy");
+    
+    // Test 4: Iteration matches a CardList with the same cards
+    mt19937 rng(8);
+    CountedCardSet counted;
+    CardList list;
+    for (int i = 0; i < 200; i++) {
+        Card c = Card::fromCode(rng() % 52);
+        if (counted.insert(c)) list.insert(c);
+    }
+    vector<Card> a, b, ra, rb;
+    for (auto it = counted.begin(); it != counted.end(); ++it) a.push_back(*it);
+    for (auto it = list.begin(); it != list.end(); ++it) b.push_back(*it);
+    for (auto it = counted.rbegin(); it != counted.rend(); ++it) ra.push_back(*it);
+    for (auto it = list.rbegin(); it != list.rend(); ++it) rb.push_back(*it);
+    assert_equal(a == b && ra == rb && counted.getSize() == list.getSize(), "Iterates like a counted CardList");
+}
+
+void test_multideck_game() {
+    cout << "\n=== Testing multi-deck games ===" << endl;
+    
+    // Test 1: Known game - one copy removed per match
+    CardList a1, b1;
+    for (const char* v : {"3", "3", "5"}) a1.insert(Card('c', v));
+    for (const char* v : {"3", "5", "5"}) b1.insert(Card('c', v));
+    stringstream out1;
+    playGame(a1, b1, out1);
+    assert_equal(out1.str() == "Alice picked matching card c 3\nBob picked matching card c 5\n"
+                 "\nAlice's cards:\nc 3\n\nBob's cards:\nc 5\n", "Each match removes one copy");
+    
+    // Test 2: CardList, multiset and fast outcome agree on random shoes
+    mt19937 rng(61);
+    bool agree = true;
+    for (int game = 0; game < 300 && agree; game++) {
+        CardList listA, listB;
+        multiset<Card> setA, setB;
+        int decks = 1 + rng() % 8;
+        for (int i = 0, n = rng() % (26 * decks + 1); i < n; i++) {
+            Card c = Card::fromCode(rng() % 52);
+            listA.insert(c);
+            setA.insert(c);
+        }
+        for (int i = 0, n = rng() % (26 * decks + 1); i < n; i++) {
+            Card c = Card::fromCode(rng() % 52);
+            listB.insert(c);
+            setB.insert(c);
+        }
+        stringstream fast, sim, sorted;
+        playFast(setA, setB, fast);
+        playGame(listA, listB, sim);
+        playSetGame(setA, setB, sorted);
+        agree = sim.str() == sorted.str() && sim.str() == fast.str();
+    }
+    assert_equal(agree, "Multi-deck engines agree");
+}
+
+// ====== Generator Tests ======
+
+void test_game_generator() {
+    cout << "\n=== Testing lazy game generator ===" << endl;
+    
+    // Test 1: Nothing runs until the first pick is asked for
+    CardList a1, b1;
+    for (const char* v : {"2", "3", "4"}) {
+        a1.insert(Card('c', v));
+        b1.insert(Card('c', v));
+    }
+    Generator<Pick> g1 = play(a1, b1);
+    assert_equal(a1.getSize() == 3, "Generator is lazy");
+    
+    // Test 2: Picks come out in game order with their player
+    assert_equal(g1.next() && g1.value().player == ALICE && g1.value().card == Card('c', "2"), "First pick is Alice's");
+    assert_equal(a1.getSize() == 2 && b1.getSize() == 2, "Yielded pick has left both hands");
+    assert_equal(g1.next() && g1.value().player == BOB && g1.value().card == Card('c', "4"), "Second pick is Bob's");
+    assert_equal(g1.next() && g1.value().card == Card('c', "3"), "Third pick");
+    assert_equal(!g1.next() && !g1.next(), "Generator finishes and stays finished");
+    
+    // Test 3: Stopping early leaves the rest of the game unplayed
+    CardList a2, b2;
+    for (int code = 0; code < 52; code++) {
+        a2.insert(Card::fromCode(code));
+        b2.insert(Card::fromCode(code));
+    }
+    int picks = 0;
+    {
+        Generator<Pick> g2 = play(a2, b2);
+        for (const Pick& pick : g2) {
+            (void)pick;
+            if (++picks == 5) break;
+        }
+    }
+    assert_equal(picks == 5 && a2.getSize() == 47 && b2.getSize() == 47, "Stop after the first N picks");
+    
+    // Test 4: Many games interleaved on one thread match running each alone
+    mt19937 rng(37);
+    const int GAMES = 200;
+    vector<CardList> alices(GAMES), bobs(GAMES);
+    vector<string> expected(GAMES);
+    for (int g = 0; g < GAMES; g++) {
+        vector<Card> handA = random_hand(rng, rng() % 101);
+        vector<Card> handB = random_hand(rng, rng() % 101);
+        CardList soloA, soloB;
+        for (const Card& c : handA) {
+            alices[g].insert(c);
+            soloA.insert(c);
+        }
+        for (const Card& c : handB) {
+            bobs[g].insert(c);
+            soloB.insert(c);
+        }
+        stringstream out;
+        playGame(soloA, soloB, out);
+        expected[g] = out.str();
+    }
+    vector<Generator<Pick>> games;
+    vector<stringstream> outs(GAMES);
+    for (int g = 0; g < GAMES; g++) {
+        games.push_back(play(alices[g], bobs[g]));
+    }
+    bool running = true;
+    while (running) {
+        running = false;
+        for (int g = 0; g < GAMES; g++) {
+            if (games[g].next()) {
+                const Pick& pick = games[g].value();
+                outs[g] << (pick.player == ALICE ? "Alice" : "Bob") << " picked matching card " << pick.card << endl;
+                running = true;
+            }
+        }
+    }
+    bool same = true;
+    for (int g = 0; g < GAMES; g++) {
+        printHands(alices[g], bobs[g], outs[g]);
+        same = same && outs[g].str() == expected[g];
+    }
+    assert_equal(same, "Interleaved games match solo games");
+}
+
+// ====== Pick Log Tests ======
+
+void test_pick_log() {
+    cout << "\n=== Testing pick logs ===" << endl;
+    
+    // Test 1: Logs of random games, multi-deck ones included, replay and round-trip
+    mt19937 rng(49);
+    bool allReplay = true;
+    bool allRoundTrip = true;
+    for (int round = 0; round < 100; round++) {
+        CardList alice, bob;
+        int copies = round % 3 + 1;
+        for (int c = 0; c < copies; c++) {
+            for (const Card& card : random_hand(rng, 50)) alice.insert(card);
+            for (const Card& card : random_hand(rng, 50)) bob.insert(card);
+        }
+        CardCounts aliceStart = countCards(alice), bobStart = countCards(bob);
+        vector<Pick> picks;
+        ostringstream out;
+        playGame(alice, bob, out, &picks);
+        PickLog log = makePickLog(aliceStart, bobStart, picks);
+        
+        PickLog back;
+        allRoundTrip = allRoundTrip && writePickLog("test_hand.plog", log) && readPickLog("test_hand.plog", back)
+                       && back.picks == log.picks && back.aliceCards == log.aliceCards && back.bobFingerprint == log.bobFingerprint;
+        CardCounts a = aliceStart, b = bobStart;
+        string error;
+        allReplay = allReplay && replayPickLog(back, a, b, error) && a == countCards(alice) && b == countCards(bob);
+    }
+    assert_equal(allRoundTrip, "Pick logs round-trip through files");
+    assert_equal(allReplay, "Replay accepts logs and ends with the game's hands");
+    
+    // Test 2: One byte per pick after a short header
+    CardList alice, bob;
+    for (const char* v : {"3", "5", "9"}) alice.insert(Card('c', v));
+    for (const char* v : {"9", "3", "k"}) bob.insert(Card('c', v));
+    CardCounts aliceStart = countCards(alice), bobStart = countCards(bob);
+    vector<Pick> picks;
+    ostringstream out;
+    playGame(alice, bob, out, &picks);
+    PickLog log = makePickLog(aliceStart, bobStart, picks);
+    writePickLog("test_hand.plog", log);
+    ifstream file("test_hand.plog", ios::binary | ios::ate);
+    assert_equal(log.picks.size() == 2 && log.picks[0] == encodePick(Pick{ALICE, Card('c', "3")})
+                 && log.picks[1] == (0x80 | Card('c', "9").toCode()) && file.tellg() < 32, "Compact encoding");
+    
+    // Test 3: Tampered, truncated and mismatched logs are rejected
+    string error;
+    CardCounts a = aliceStart, b = bobStart;
+    PickLog swapped = log;
+    swap(swapped.picks[0], swapped.picks[1]);
+    assert_equal(!replayPickLog(swapped, a, b, error) && error.find("Pick 1") != string::npos, "Wrong pick found");
+    a = aliceStart;
+    b = bobStart;
+    PickLog cut = log;
+    cut.picks.pop_back();
+    assert_equal(!replayPickLog(cut, a, b, error) && error.find("goes on") != string::npos, "Truncated log found");
+    a = bobStart;
+    b = aliceStart;
+    assert_equal(!replayPickLog(log, a, b, error), "Log for other hands rejected");
+    
+    // Test 4: Hands only the validating reader accepts replay as game loaded them
+    { ofstream f("test_hand.a"); f << "h10\nc 3\nd 5\n"; }
+    { ofstream f("test_hand.b"); f << "h 10\nx 4\nc 3\n"; }
+    vector<uint8_t> codes;
+    bool sorted;
+    assert_equal(!readHand("test_hand.a", codes, sorted) && !readHand("test_hand.b", codes, sorted), "Bulk reader refuses both");
+    ostringstream report;
+    vector<Card> aliceCards, bobCards;
+    assert_equal(!loadHandCards("test_hand.b", REJECT_BAD_CARDS, 1, bobCards, sorted, report), "Reject policy fails the load");
+    report.str("");
+    bool loaded = loadHandCards("test_hand.a", SKIP_BAD_CARDS, 1, aliceCards, sorted, report)
+                  && loadHandCards("test_hand.b", SKIP_BAD_CARDS, 1, bobCards, sorted, report);
+    assert_equal(loaded && aliceCards.size() == 3 && bobCards.size() == 2
+                 && report.str().find("test_hand.b:2:") != string::npos && report.str().find("(skipped)") != string::npos,
+                 "Skip policy loads and reports");
+    CardList aliceHand, bobHand;
+    for (const Card& c : aliceCards) aliceHand.insert(c);
+    for (const Card& c : bobCards) bobHand.insert(c);
+    aliceStart = countCards(aliceHand);
+    bobStart = countCards(bobHand);
+    picks.clear();
+    playGame(aliceHand, bobHand, out, &picks);
+    PickLog fromFiles = makePickLog(aliceStart, bobStart, picks);
+    loaded = loadHandCards("test_hand.a", SKIP_BAD_CARDS, 1, aliceCards, sorted, report)
+             && loadHandCards("test_hand.b", SKIP_BAD_CARDS, 1, bobCards, sorted, report);
+    a = countCards(aliceCards);
+    b = countCards(bobCards);
+    assert_equal(loaded && picks.size() == 2 && replayPickLog(fromFiles, a, b, error), "Log replays against reloaded files");
+    remove("test_hand.a");
+    remove("test_hand.b");
+    remove("test_hand.plog");
+}
+
+// ====== SuitedCardList Tests ======
+
+void test_suited_cardlist() {
+    cout << "\n=== Testing SuitedCardList ===" << endl;
+    
+    // Test 1: Same contents and order as CardList, copies included
+    mt19937 rng(42);
+    CardList list;
+    SuitedCardList suited;
+    for (int i = 0; i < 120; i++) {
+        Card c = Card::fromCode(rng() % 52);
+        list.insert(c);
+        suited.insert(c);
+    }
+    for (int i = 0; i < 40; i++) {
+        Card c = Card::fromCode(rng() % 52);
+        list.erase(c);
+        suited.erase(c);
+    }
+    assert_equal(ranges::equal(list, suited) && suited.size() == list.size(), "Forward order matches CardList");
+    vector<Card> fromList(list.rbegin(), list.rend()), fromSuited(suited.rbegin(), suited.rend());
+    assert_equal(fromList == fromSuited, "Reverse order matches CardList");
+    auto last = suited.end();
+    --last;
+    assert_equal(*last == *list.rbegin(), "--end() is the largest card");
+    
+    // Test 2: Suit summary tracks empty suits
+    SuitedCardList hand;
+    hand.insert("d3"_card);
+    hand.insert("d3"_card);
+    hand.insert("h9"_card);
+    assert_equal(hand.heldSuits() == 0b1010 && hand.suitRanks('d') == 0b100, "Suit and rank masks");
+    hand.erase("d3"_card);
+    assert_equal(hand.heldSuits() == 0b1010 && hand.count("d3"_card) == 1, "Suit stays while a copy is left");
+    hand.erase("d3"_card);
+    assert_equal(hand.heldSuits() == 0b1000 && !hand.contains("d3"_card), "Suit cleared with its last card");
+    hand.insert(Card('x', "3"));
+    assert_equal(hand.size() == 1, "Non-deck cards are ignored");
+    
+    // Test 3: Shared-card search
+    SuitedCardList a, b;
+    for (Card c : {"c2"_card, "s5"_card, "s9"_card, "hk"_card}) a.insert(c);
+    for (Card c : {"d2"_card, "s5"_card, "s9"_card, "ha"_card}) b.insert(c);
+    assert_equal(*a.firstShared(b) == "s5"_card && *a.lastShared(b) == "s9"_card, "First and last shared card");
+    SuitedCardList none;
+    assert_equal(a.firstShared(none) == a.end() && a.lastShared(none) == a.rend(), "No shared card");
+    
+    // Test 4: The suited game prints the same as the CardList game
+    bool same = true;
+    for (int game = 0; game < 300 && same; game++) {
+        CardList listA, listB;
+        SuitedCardList suitedA, suitedB;
+        for (int i = 0, n = rng() % 80; i < n; i++) {
+            Card c = Card::fromCode(rng() % 52);
+            listA.insert(c);
+            suitedA.insert(c);
+        }
+        for (int i = 0, n = rng() % 80; i < n; i++) {
+            Card c = Card::fromCode(rng() % 52);
+            listB.insert(c);
+            suitedB.insert(c);
+        }
+        stringstream expected, actual;
+        playGame(listA, listB, expected);
+        playGame(suitedA, suitedB, actual);
+        same = expected.str() == actual.str();
+    }
+    assert_equal(same, "Suited game matches CardList game");
+}
+
+// ====== Packed Intersection Tests ======
+
+void test_packed_intersection() {
+    cout << "\n=== Testing Packed Intersection ===" << endl;
+    
+    // Test 1: Packing numbers the copies of each card
+    vector<uint8_t> codes = {3, 3, 3, 7, 51};
+    vector<uint16_t> keys;
+    assert_equal(packHand(codes.data(), codes.size(), keys), "Pack sorted codes");
+    assert_equal(keys[2] == (3 << PACKED_COPY_BITS | 2) && packedCode(keys[4]) == 51, "Key is code and copy");
+    vector<uint8_t> descending = {5, 4}, invalid = {52};
+    assert_equal(!packHand(descending.data(), 2, keys) && !packHand(invalid.data(), 1, keys), "Unsorted or invalid codes rejected");
+    vector<uint8_t> tooMany(1025, 9);
+    assert_equal(!packHand(tooMany.data(), tooMany.size(), keys), "More than 1024 copies rejected");
+    
+    // Test 2: Every kernel matches std::set_* on balanced and lopsided hands
+    mt19937 rng(43);
+    bool same = true;
+    for (int trial = 0; trial < 400 && same; trial++) {
+        vector<uint16_t> hands[2];
+        for (int h = 0; h < 2; h++) {
+            // Sizes from empty to a few hundred cards, sometimes 50x apart
+            size_t n = rng() % (trial % 3 == 0 && h == 1 ? 2000 : 120);
+            vector<uint8_t> cards(n);
+            for (uint8_t& c : cards) c = rng() % (trial % 2 ? 52 : 6);
+            sort(cards.begin(), cards.end());
+            packHand(cards.data(), cards.size(), hands[h]);
+        }
+        const vector<uint16_t>& a = hands[0];
+        const vector<uint16_t>& b = hands[1];
+        vector<uint16_t> expectShared, expectA, expectB;
+        set_intersection(a.begin(), a.end(), b.begin(), b.end(), back_inserter(expectShared));
+        set_difference(a.begin(), a.end(), b.begin(), b.end(), back_inserter(expectA));
+        set_difference(b.begin(), b.end(), a.begin(), a.end(), back_inserter(expectB));
+        
+        for (IntersectKernel kernel : {INTERSECT_SCALAR, INTERSECT_SSE42}) {
+            if (!intersectKernelSupported(kernel)) continue;
+            for (int swapped = 0; swapped < 2; swapped++) {
+                const vector<uint16_t>& x = swapped ? b : a;
+                const vector<uint16_t>& y = swapped ? a : b;
+                vector<uint16_t> shared(min(a.size(), b.size())), onlyX(x.size()), onlyY(y.size());
+                IntersectResult r = intersectPackedWith(kernel, x.data(), x.size(), y.data(), y.size(),
+                                                        shared.data(), onlyX.data(), onlyY.data());
+                shared.resize(r.shared);
+                onlyX.resize(r.onlyA);
+                onlyY.resize(r.onlyB);
+                same = same && shared == expectShared && onlyX == (swapped ? expectB : expectA)
+                       && onlyY == (swapped ? expectA : expectB);
+            }
+        }
+    }
+    assert_equal(same, "Kernels match std::set_intersection/set_difference");
+    
+    // Test 3: The packed fast game prints the same as the simulated one
+    same = true;
+    for (int game = 0; game < 200 && same; game++) {
+        CardList listA, listB;
+        vector<uint8_t> codesA, codesB;
+        for (int i = 0, n = rng() % 80; i < n; i++) codesA.push_back(rng() % 52);
+        for (int i = 0, n = rng() % 80; i < n; i++) codesB.push_back(rng() % 52);
+        for (uint8_t c : codesA) listA.insert(Card::fromCode(c));
+        for (uint8_t c : codesB) listB.insert(Card::fromCode(c));
+        sort(codesA.begin(), codesA.end());
+        sort(codesB.begin(), codesB.end());
+        vector<uint16_t> packedA, packedB;
+        packHand(codesA.data(), codesA.size(), packedA);
+        packHand(codesB.data(), codesB.size(), packedB);
+        stringstream expected, actual;
+        playGame(listA, listB, expected);
+        playFastPacked(packedA, packedB, actual);
+        same = expected.str() == actual.str();
+    }
+    assert_equal(same, "Packed fast game matches simulation");
+}
+
+// ====== Tournament Tests ======
+
+void test_tournament() {
+    cout << "\n=== Testing Tournament ===" << endl;
+    
+    // Test 1: Two players play exactly the game, multi-deck hands included
+    mt19937 rng(36);
+    bool same = true;
+    for (int game = 0; game < 300 && same; game++) {
+        vector<TournamentPlayer> players(2);
+        players[0] = {"Alice", {}, SCAN_ASCENDING};
+        players[1] = {"Bob", {}, SCAN_DESCENDING};
+        CardList alice, bob;
+        int decks = 1 + rng() % 3;
+        for (int p = 0; p < 2; p++) {
+            for (int i = 0, n = rng() % (26 * decks + 1); i < n; i++) {
+                Card c = Card::fromCode(rng() % 52);
+                players[p].hand.push_back(c);
+                (p == 0 ? alice : bob).insert(c);
+            }
+        }
+        stringstream expected, actual;
+        playGame(alice, bob, expected);
+        Tournament(players, {}).play(actual);
+        same = expected.str() == actual.str();
+    }
+    assert_equal(same, "Two-player tournament matches the game");
+    
+    // Test 2: A pick removes the card from every holder
+    vector<TournamentPlayer> three(3);
+    three[0] = {"A", {Card('c', "2"), Card('c', "5")}, SCAN_ASCENDING};
+    three[1] = {"B", {Card('c', "2"), Card('h', "k")}, SCAN_DESCENDING};
+    three[2] = {"C", {Card('c', "2"), Card('c', "5"), Card('h', "k")}, SCAN_DESCENDING};
+    Tournament t(three, {});
+    assert_equal(t.takeTurn(0) == Card('c', "2").toCode(), "A takes the smallest shared card");
+    assert_equal(t.hand(0).size() == 1 && t.hand(1).size() == 1 && t.hand(2).size() == 2, "Shared card leaves all three hands");
+    assert_equal(t.takeTurn(1) == Card('h', "k").toCode(), "B takes the largest shared card");
+    assert_equal(t.takeTurn(1) == -1, "B has nothing left to match");
+    assert_equal(t.takeTurn(2) == Card('c', "5").toCode(), "C matches A's remaining card");
+    assert_equal(t.hand(0).empty() && t.hand(2).empty(), "All matches played");
+    
+    // Test 3: Turn order decides who gets the contested card
+    vector<TournamentPlayer> rivals(3);
+    rivals[0] = {"A", {Card('d', "7")}, SCAN_ASCENDING};
+    rivals[1] = {"B", {Card('d', "7")}, SCAN_ASCENDING};
+    rivals[2] = {"C", {Card('d', "7")}, SCAN_ASCENDING};
+    stringstream out;
+    Tournament(rivals, {2, 0, 1}).play(out);
+    assert_equal(out.str() == "C picked matching card d 7\n\nA's cards:\n\nB's cards:\n\nC's cards:\n", "Custom turn order");
+}
+
+// ====== Tracing Tests ======
+
+// Runs last: tracing can't be switched off again once enabled
+void test_tracing() {
+    cout << "\n=== Testing tracing ===" << endl;
+    
+    // Test 1: Spans are dropped while tracing is off
+    { TRACE_SCOPE("before enable"); }
+    
+    // Test 2: Each thread's ring keeps its most recent spans
+    traceEnable(4);
+    traceThreadName("test main");
+    for (int i = 0; i < 10; i++) {
+        TRACE_SCOPE("tiny");
+    }
+    thread worker([]() {
+        traceThreadName("test worker");
+        TRACE_SCOPE("worker span");
+    });
+    worker.join();
+    thread oddName([]() {
+        traceThreadName("load a\"b\\c\nd.txt");
+        TRACE_SCOPE("odd span");
+    });
+    oddName.join();
+    assert_equal(traceWrite("test_hand.trace.json"), "Trace file written");
+    
+    ifstream file("test_hand.trace.json");
+    string json((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    size_t tiny = 0;
+    for (size_t pos = json.find("\"tiny\""); pos != string::npos; pos = json.find("\"tiny\"", pos + 1)) tiny++;
+    assert_equal(json.find("before enable") == string::npos, "Disabled spans not recorded");
+    assert_equal(tiny == 4, "Ring buffer keeps the last spans");
+    assert_equal(json.find("\"worker span\",\"ph\":\"X\",\"pid\":1,\"tid\":2") != string::npos, "Worker span on its own track");
+    assert_equal(json.find("test main") != string::npos && json.find("test worker") != string::npos, "Tracks are named");
+    assert_equal(json.find("\"load a\\\"b\\\\c\\u000ad.txt\"") != string::npos, "Names are escaped in the JSON");
+    
+    // Test 3: Threads that come and go reuse buffers, so trace memory stays flat
+    auto shortLived = []() {
+        thread t([]() {
+            traceThreadName("short lived");
+            TRACE_SCOPE("short span");
+        });
+        t.join();
+    };
+    for (int i = 0; i < 100; i++) shortLived();
+    long long churnLive;
+    {
+        HeapScope heap;
+        for (int i = 0; i < 200; i++) shortLived();
+        churnLive = heap.liveBytes();
+    }
+    assert_equal(churnLive == 0, "Exited threads' buffers are recycled");
+    remove("test_hand.trace.json");
+}
+
+// ====== Daemon Tests ======
+
+void test_game_daemon() {
+    cout << "\n=== Testing game daemon ===" << endl;
+    
+    GameDaemon daemon("test_hand.sock", 2, 4, 300);
+    string error;
+    assert_equal(daemon.start(error), "Daemon starts");
+    int fd = connectDaemon("test_hand.sock");
+    assert_equal(fd >= 0, "Client connects");
+    
+    // Pipeline text and binary games, half of them --fast, before reading anything
+    mt19937 rng(47);
+    vector<string> expected;
+    for (uint32_t id = 0; id < 40; id++) {
+        vector<Card> a = random_hand(rng, 40), b = random_hand(rng, 40);
+        CardList alice, bob;
+        for (const Card& c : a) alice.insert(c);
+        for (const Card& c : b) bob.insert(c);
+        ostringstream out;
+        if (id % 2) playFast(alice, bob, out); else playGame(alice, bob, out);
+        expected.push_back(out.str());
+        
+        uint8_t flags = id % 2 ? DAEMON_FAST : 0;
+        if (id % 4 < 2) {
+            string text;
+            for (const Card& c : a) text += string(1, c.getSuit()) + " " + c.getValue() + "\n";
+            text += "--\n";
+            for (const Card& c : b) text += string(1, c.getSuit()) + " " + c.getValue() + "\n";
+            sendRequest(fd, id, DAEMON_TEXT, flags, text);
+        } else {
+            vector<uint8_t> ac, bc;
+            for (const Card& c : a) ac.push_back(uint8_t(c.toCode()));
+            for (const Card& c : b) bc.push_back(uint8_t(c.toCode()));
+            sendRequest(fd, id, DAEMON_BINARY, flags, binaryHandsPayload(ac, bc));
+        }
+    }
+    sendRequest(fd, 99, DAEMON_BINARY, 0, binaryHandsPayload({1, 60}, {2}));
+    sendRequest(fd, 98, DAEMON_TEXT, 0, "h 3\nx 4\n--\nh 3\n");
+    
+    // Test 1: Every response matches the game, in whatever order they arrive
+    bool allMatch = true;
+    bool badRejected = false;
+    bool badTextRejected = false;
+    for (int i = 0; i < 42; i++) {
+        uint32_t id;
+        uint8_t status;
+        string text;
+        if (!readResponse(fd, id, status, text)) {
+            allMatch = false;
+            break;
+        }
+        if (id == 99) badRejected = status == DAEMON_ERROR;
+        else if (id == 98) badTextRejected = status == DAEMON_ERROR && text.find("Alice's hand:2:") != string::npos;
+        else allMatch = allMatch && id < 40 && status == DAEMON_OK && text == expected[id];
+    }
+    assert_equal(allMatch, "Daemon results match playGame/playFast");
+    assert_equal(badRejected, "Bad card code is an error response");
+    assert_equal(badTextRejected, "Bad text card is an error response");
+    
+    // Test 2: Metrics count the requests and have latencies
+    uint32_t id;
+    uint8_t status;
+    string text;
+    sendRequest(fd, 7, DAEMON_METRICS, 0, "");
+    assert_equal(readResponse(fd, id, status, text) && id == 7 && text.find("requests 42\n") != string::npos
+                 && text.find("errors 2\n") != string::npos, "Metrics request");
+    DaemonMetrics metrics = daemon.metrics();
+    assert_equal(metrics.p50Micros <= metrics.p99Micros && metrics.batches <= metrics.requests, "Latency percentiles ordered");
+    
+    // Test 3: A client that pipelines without ever reading is dropped once its
+    // responses back up, and other clients are served meanwhile
+    int stalled = connectDaemon("test_hand.sock");
+    vector<uint8_t> deck(52);
+    for (int code = 0; code < 52; code++) deck[code] = uint8_t(code);
+    string payload = binaryHandsPayload(deck, deck);
+    atomic<bool> flooded(false);
+    thread flood([&]() {
+        for (uint32_t i = 0; i < 100000 && sendRequest(stalled, i, DAEMON_BINARY, 0, payload); i++) {}
+        flooded = true;
+    });
+    bool served = true;
+    auto slowest = chrono::steady_clock::duration::zero();
+    for (uint32_t i = 0; i < 20; i++) {
+        auto sentAt = chrono::steady_clock::now();
+        served = served && sendRequest(fd, i, DAEMON_BINARY, DAEMON_FAST, payload) && readResponse(fd, id, status, text)
+                 && id == i && status == DAEMON_OK;
+        slowest = max(slowest, chrono::steady_clock::now() - sentAt);
+    }
+    assert_equal(served, "Other clients served during a flood");
+    assert_equal(slowest < chrono::milliseconds(150), "A stalled client's send timeout doesn't delay others");
+    for (int wait = 0; wait < 100 && !flooded; wait++) {
+        this_thread::sleep_for(chrono::milliseconds(100));
+    }
+    bool dropped = flooded;
+    if (!dropped) shutdown(stalled, SHUT_RDWR);
+    flood.join();
+    size_t drained = 0;
+    while (readResponse(stalled, id, status, text)) drained++;
+    assert_equal(dropped && drained < 100000, "Client that never reads is dropped");
+    close(stalled);
+    close(fd);
+    
+    // Test 4: Stop closes clients and removes the socket
+    daemon.stop();
+    assert_equal(connectDaemon("test_hand.sock") < 0, "Socket gone after stop");
+}
+
 int main() {
     cout << "=====================================" << endl;
     cout << "  CARD AND CARDLIST TEST SUITE" << endl;
@@ -529,6 +2332,7 @@ int main() {
     test_card_comparison_equal();
     test_card_comparison_greater();
     test_card_io_operators();
+    test_validating_card_parse();
     
     // CardList class tests
     test_cardlist_insert();
@@ -539,6 +2343,65 @@ int main() {
     test_cardlist_iterator_reverse();
     test_cardlist_erase_via_iterator();
     test_cardlist_ordering();
+    test_cardlist_standard_iterators();
+    test_cardlist_split_join();
+    test_cardlist_node_pool();
+    test_cardlist_bulk_erase();
+    
+    // Memory tests
+    test_cardlist_memory();
+    
+    // PersistentCardList tests
+    test_persistent_cardlist();
+    
+    // ConcurrentCardSet tests
+    test_card_codes();
+    test_constexpr_cards();
+    test_concurrent_card_set();
+    
+    // SnapshotCardList tests
+    test_snapshot_cardlist();
+    
+    // Game outcome tests
+    test_fast_outcome_matches_simulation();
+    
+    test_game_generator();
+    
+    // Pick log tests
+    test_pick_log();
+    
+    // Hand parser tests
+    test_hand_parser();
+    test_binary_hand_files();
+    test_parallel_hand_loading();
+    
+    // Multi-deck tests
+    test_multideck_cardlist();
+    test_counted_card_set();
+    test_multideck_game();
+    
+    // SuitedCardList tests
+    test_suited_cardlist();
+    
+    // Packed intersection tests
+    test_packed_intersection();
+    
+    // Tournament tests
+    test_tournament();
+    
+    // Hand store tests
+    test_hand_store();
+    
+    // Streaming pipeline tests
+    test_bounded_queue();
+    test_stream_mode();
+    test_stream_checkpoint();
+    
+    // Tracing tests
+    test_tracing();
+    
+    // Daemon tests
+    test_game_daemon();
     
     cout << "\n=====================================" << endl;
     cout << "  ALL TESTS PASSED!" << endl;
@@ -0,0 +1,111 @@
+// tournament.cpp
+// Author: Yusen Liu
+// Implementation of the classes defined in tournament.h
+
+#include "tournament.h"
+#include <cstring>
+
+// ====== Helper Functions ======
+
+// Recompute the shared bit for one card for every player in affected
+void Tournament::refreshShared(int code, uint64_t affected) {
+    uint64_t bit = uint64_t(1) << code;
+    bool contested = __builtin_popcountll(owners[code]) >= 2;
+    while (affected != 0) {
+        int p = __builtin_ctzll(affected);
+        affected &= affected - 1;
+        if (contested && ((owners[code] >> p) & 1)) {
+            players[p].shared |= bit;
+        } else {
+            players[p].shared &= ~bit;
+        }
+    }
+}
+
+// ====== Tournament Methods ======
+
+Tournament::Tournament(const std::vector<TournamentPlayer>& setup, const std::vector<int>& order)
+    : turnOrder(order) {
+    memset(owners, 0, sizeof(owners));
+
+    for (size_t p = 0; p < setup.size() && p < size_t(MAX_PLAYERS); p++) {
+        PlayerState state;
+        state.name = setup[p].name;
+        state.direction = setup[p].direction;
+        memset(state.counts, 0, sizeof(state.counts));
+        state.shared = 0;
+        for (const Card& card : setup[p].hand) {
+            int code = card.toCode();
+            if (code < 0) continue;
+            state.counts[code]++;
+            owners[code] |= uint64_t(1) << p;
+        }
+        players.push_back(state);
+    }
+
+    if (turnOrder.empty()) {
+        for (int p = 0; p < playerCount(); p++) {
+            turnOrder.push_back(p);
+        }
+    }
+
+    uint64_t everyone = playerCount() == 64 ? ~uint64_t(0) : (uint64_t(1) << playerCount()) - 1;
+    for (int code = 0; code < 52; code++) {
+        refreshShared(code, everyone);
+    }
+}
+
+int Tournament::takeTurn(int p) {
+    uint64_t shared = players[p].shared;
+    if (shared == 0) return -1;
+
+    // First shared card in the player's scan direction
+    int code = players[p].direction == SCAN_ASCENDING ? __builtin_ctzll(shared) : 63 - __builtin_clzll(shared);
+
+    // One copy leaves every holder, the picker included
+    uint64_t holders = owners[code];
+    for (uint64_t rest = holders; rest != 0; rest &= rest - 1) {
+        int h = __builtin_ctzll(rest);
+        if (--players[h].counts[code] == 0) owners[code] &= ~(uint64_t(1) << h);
+    }
+    refreshShared(code, holders);
+    return code;
+}
+
+void Tournament::play(std::ostream& out) {
+    while (true) {
+        bool picked = false;
+        for (int p : turnOrder) {
+            int code = takeTurn(p);
+            if (code >= 0) {
+                out << players[p].name << " picked matching card " << Card::fromCode(code) << std::endl;
+                picked = true;
+            }
+        }
+        if (!picked) break; // no more matches
+    }
+
+    for (int p = 0; p < playerCount(); p++) {
+        out << std::endl;
+        out << players[p].name << "'s cards:" << std::endl;
+        for (const Card& card : hand(p)) {
+            out << card << std::endl;
+        }
+    }
+}
+
+std::vector<Card> Tournament::hand(int p) const {
+    std::vector<Card> cards;
+    for (int code = 0; code < 52; code++) {
+        cards.insert(cards.end(), players[p].counts[code], Card::fromCode(code));
+    }
+    return cards;
+}
+
+const std::string& Tournament::name(int p) const {
+    return players[p].name;
+}
+
+int Tournament::playerCount() const {
+    return int(players.size());
+}
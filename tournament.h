@@ -0,0 +1,68 @@
+// tournament.h
+// Author: Yusen Liu
+// N-player generalization of the card matching game.
+//
+// Players take turns in a configurable order. On their turn a player scans their
+// own hand in their own direction (ascending like Alice, or descending like Bob)
+// for the first card some other player also holds, and that card is removed once
+// from the picker and once from every other holder. The game ends after a full
+// round with no pick. With two players, Alice ascending then Bob descending, the
+// output is identical to game's.
+//
+// Instead of scanning hands, the engine keeps for every card a bitmask of the
+// players holding it, and for every player a 52-bit mask of the cards they share
+// with someone. A turn is a find-first-set on that mask, and a pick only touches
+// the players holding the picked card.
+
+#ifndef TOURNAMENT_H
+#define TOURNAMENT_H
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "card.h"
+
+enum ScanDirection { SCAN_ASCENDING, SCAN_DESCENDING };
+
+struct TournamentPlayer {
+    std::string name;
+    std::vector<Card> hand;     // cards outside the standard deck are ignored
+    ScanDirection direction;
+};
+
+class Tournament {
+public:
+    static constexpr int MAX_PLAYERS = 64;
+
+private:
+    struct PlayerState {
+        std::string name;
+        ScanDirection direction;
+        uint32_t counts[52];    // copies held of each card code
+        uint64_t shared;        // codes this player holds and someone else also holds
+    };
+
+    std::vector<PlayerState> players;
+    std::vector<int> turnOrder;
+    uint64_t owners[52];        // bit p set when player p holds the card
+
+    void refreshShared(int code, uint64_t affected);
+
+public:
+    // turnOrder lists player indexes in the order they move each round; empty means 0..N-1
+    Tournament(const std::vector<TournamentPlayer>& players, const std::vector<int>& turnOrder);
+
+    // Play one turn for player p. Returns the code picked, or -1 if p has no match.
+    int takeTurn(int p);
+
+    // Play to the end, printing every pick and then each player's remaining cards
+    void play(std::ostream& out);
+
+    // Remaining cards of player p, ascending, every copy
+    std::vector<Card> hand(int p) const;
+    const std::string& name(int p) const;
+    int playerCount() const;
+};
+
+#endif
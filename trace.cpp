@@ -0,0 +1,194 @@
+// trace.cpp
+// Author: Yusen Liu
+// Implementation of the functions declared in trace.h
+
+#include "trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> traceActive(false);
+
+struct TraceEvent {
+    const char* name;
+    int64_t start;
+    int64_t end;
+};
+
+// One per live thread that has recorded a span
+struct TraceBuffer {
+    int tid;
+    std::string threadName;
+    std::vector<TraceEvent> events;
+    size_t written = 0;     // total ever recorded; the ring holds the last events.size()
+};
+
+// A span of a thread that has exited
+struct RetiredEvent {
+    TraceEvent event;
+    int tid;
+};
+
+// When a thread exits its spans move to the retired ring and its buffer goes on
+// the free list for the next thread, so a process that keeps starting threads
+// (a daemon with one reader per connection) holds a fixed amount of trace
+// memory. The ring keeps the last RETIRED_THREADS buffers' worth of spans, and
+// the names of the threads that still have spans in it.
+static const size_t RETIRED_THREADS = 8;
+
+static std::mutex registryLock;
+static std::vector<std::unique_ptr<TraceBuffer>> buffers;
+static std::vector<std::unique_ptr<TraceBuffer>> freeBuffers;
+static std::vector<RetiredEvent> retired;
+static size_t retiredWritten = 0;
+static std::map<int, std::pair<std::string, size_t>> retiredThreads;   // tid -> name, spans in the ring
+static int nextTid = 1;
+static size_t bufferEvents = 1 << 16;
+static std::chrono::steady_clock::time_point epoch;
+
+// Releases the thread's buffer when the thread exits
+struct LocalBuffer {
+    TraceBuffer* buffer = nullptr;
+    ~LocalBuffer();
+};
+static thread_local LocalBuffer localBuffer;
+
+// ====== Helper Functions ======
+
+static std::string trackName(const TraceBuffer& buffer) {
+    return buffer.threadName.empty() ? "thread " + std::to_string(buffer.tid) : buffer.threadName;
+}
+
+static TraceBuffer* threadBuffer() {
+    if (localBuffer.buffer == nullptr) {
+        std::lock_guard<std::mutex> lock(registryLock);
+        std::unique_ptr<TraceBuffer> buffer;
+        if (freeBuffers.empty()) {
+            buffer = std::make_unique<TraceBuffer>();
+        } else {
+            buffer = std::move(freeBuffers.back());
+            freeBuffers.pop_back();
+        }
+        buffer->tid = nextTid++;
+        buffer->events.resize(bufferEvents);
+        localBuffer.buffer = buffer.get();
+        buffers.push_back(std::move(buffer));
+    }
+    return localBuffer.buffer;
+}
+
+// Flush the exiting thread's spans into the retired ring, oldest first, and
+// recycle its buffer
+LocalBuffer::~LocalBuffer() {
+    if (buffer == nullptr) return;
+    std::lock_guard<std::mutex> lock(registryLock);
+    size_t capacity = bufferEvents * RETIRED_THREADS;
+    size_t kept = std::min(buffer->written, buffer->events.size());
+    if (kept > 0) retiredThreads[buffer->tid] = {trackName(*buffer), 0};
+    for (size_t i = buffer->written - kept; i < buffer->written; i++) {
+        RetiredEvent event{buffer->events[i % buffer->events.size()], buffer->tid};
+        if (retired.size() < capacity && retiredWritten == retired.size()) {
+            retired.push_back(event);
+        } else {
+            // Overwrite the oldest span, and forget its thread with its last span
+            RetiredEvent& slot = retired[retiredWritten % retired.size()];
+            auto old = retiredThreads.find(slot.tid);
+            if (old != retiredThreads.end() && --old->second.second == 0) retiredThreads.erase(old);
+            slot = event;
+        }
+        retiredWritten++;
+        retiredThreads[buffer->tid].second++;
+    }
+
+    auto owned = std::find_if(buffers.begin(), buffers.end(), [&](const auto& b) { return b.get() == buffer; });
+    buffer->threadName.clear();
+    buffer->written = 0;
+    freeBuffers.push_back(std::move(*owned));
+    buffers.erase(owned);
+    buffer = nullptr;
+}
+
+// ====== Recording ======
+
+void traceEnable(size_t eventsPerThread) {
+    std::lock_guard<std::mutex> lock(registryLock);
+    bufferEvents = std::max<size_t>(eventsPerThread, 1);
+    epoch = std::chrono::steady_clock::now();
+    traceActive.store(true, std::memory_order_release);
+}
+
+void traceThreadName(const std::string& name) {
+    if (traceEnabled()) threadBuffer()->threadName = name;
+}
+
+int64_t traceNow() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void traceRecord(const char* name, int64_t start, int64_t end) {
+    TraceBuffer* buffer = threadBuffer();
+    buffer->events[buffer->written % buffer->events.size()] = TraceEvent{name, start, end};
+    buffer->written++;
+}
+
+// ====== Output ======
+
+// A name as the body of a JSON string: quotes, backslashes and control
+// characters escaped (thread names can hold file paths)
+static std::string jsonEscape(const std::string& text) {
+    std::string out;
+    out.reserve(text.size());
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if ((unsigned char)c < 0x20) {
+            char code[8];
+            snprintf(code, sizeof(code), "\\u%04x", (unsigned char)c);
+            out += code;
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+bool traceWrite(const std::string& path) {
+    FILE* file = fopen(path.c_str(), "w");
+    if (file == nullptr) return false;
+
+    std::lock_guard<std::mutex> lock(registryLock);
+    fprintf(file, "{\"traceEvents\":[\n");
+    bool first = true;
+    for (const auto& buffer : buffers) {
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                first ? "" : ",\n", buffer->tid, jsonEscape(trackName(*buffer)).c_str());
+        first = false;
+
+        // Oldest surviving span first
+        size_t kept = std::min(buffer->written, buffer->events.size());
+        for (size_t i = buffer->written - kept; i < buffer->written; i++) {
+            const TraceEvent& e = buffer->events[i % buffer->events.size()];
+            fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                    jsonEscape(e.name).c_str(), buffer->tid, e.start / 1000.0, (e.end - e.start) / 1000.0);
+        }
+    }
+
+    // Exited threads: their names, then the ring oldest first
+    for (const auto& [tid, thread] : retiredThreads) {
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                first ? "" : ",\n", tid, jsonEscape(thread.first).c_str());
+        first = false;
+    }
+    for (size_t i = retiredWritten - retired.size(); i < retiredWritten; i++) {
+        const RetiredEvent& r = retired[i % retired.size()];
+        fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                jsonEscape(r.event.name).c_str(), r.tid, r.event.start / 1000.0, (r.event.end - r.event.start) / 1000.0);
+    }
+    fprintf(file, "\n]}\n");
+    return fclose(file) == 0;
+}
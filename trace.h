@@ -0,0 +1,65 @@
+// trace.h
+// Author: Yusen Liu
+// Lightweight scoped tracing. TRACE_SCOPE("name") records a span from the line
+// it's on to the end of the enclosing block into a ring buffer owned by the
+// calling thread, and traceWrite() dumps every thread's spans as Chrome
+// trace-event JSON (open it in chrome://tracing or ui.perfetto.dev), one track
+// per thread. When a thread exits, its spans move to a shared ring holding the
+// most recent spans of exited threads, and its buffer is reused.
+//
+// While tracing is off a span costs one relaxed atomic load and a branch;
+// building with -DNO_TRACE compiles the spans out entirely. Span names must be
+// string literals (only the pointer is stored).
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+extern std::atomic<bool> traceActive;
+
+inline bool traceEnabled() {
+    return traceActive.load(std::memory_order_relaxed);
+}
+
+// Start recording; each thread keeps its last eventsPerThread spans
+void traceEnable(size_t eventsPerThread = 1 << 16);
+
+// Label the calling thread's track (shown instead of "thread N")
+void traceThreadName(const std::string& name);
+
+// Write everything recorded so far. Call once the traced threads have finished.
+bool traceWrite(const std::string& path);
+
+// Nanoseconds since tracing was enabled
+int64_t traceNow();
+void traceRecord(const char* name, int64_t start, int64_t end);
+
+class TraceScope {
+private:
+    const char* name;
+    int64_t start;      // -1 while tracing is off
+
+public:
+    explicit TraceScope(const char* n) : name(n), start(traceEnabled() ? traceNow() : -1) {}
+    ~TraceScope() {
+        if (start >= 0) traceRecord(name, start, traceNow());
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#ifdef NO_TRACE
+#define TRACE_SCOPE(name) ((void)0)
+#else
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope_, __LINE__)(name)
+#endif
+
+#endif